@@ -29,12 +29,111 @@
 #include "fold_adjacent.h"
 #include <numeric>
 #include <future>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <utility>
 
 namespace cxxcam
 {
 namespace simulation
 {
 
+namespace
+{
+
+using mesh::dot;
+
+mesh::point_3 face_normal(const mesh::mesh_t& m, const std::vector<std::size_t>& face)
+{
+	return mesh::newell_normal(m.vertices, face);
+}
+
+mesh::point_3 to_point(const math::point_3& p)
+{
+	using units::length_mm;
+	return {length_mm(p.x).value(), length_mm(p.y).value(), length_mm(p.z).value()};
+}
+
+// Rotated copy of the tool mesh; the same rotation geom::rotate applies
+mesh::mesh_t rotate(const mesh::mesh_t& m, const math::quaternion_t& o)
+{
+	auto q = o / abs(o);
+	auto r = m;
+	for(auto& v : r.vertices)
+	{
+		auto p = q * math::quaternion_t(0, v.x, v.y, v.z) * conj(q);
+		v = {p.R_component_2(), p.R_component_3(), p.R_component_4()};
+	}
+	return r;
+}
+
+mesh::mesh_t sweep_convex(const mesh::mesh_t& tool, const mesh::point_3& p0, const mesh::point_3& d)
+{
+	static const double epsilon = 1e-9;
+	auto length = std::sqrt(dot(d, d));
+	auto nv = tool.vertices.size();
+
+	std::vector<bool> front;
+	front.reserve(tool.faces.size());
+	std::map<std::pair<std::size_t, std::size_t>, std::size_t> edge_face;
+	for(std::size_t i = 0; i < tool.faces.size(); ++i)
+	{
+		auto& face = tool.faces[i];
+		auto n = face_normal(tool, face);
+		front.push_back(dot(n, d) > epsilon * std::sqrt(dot(n, n)) * length);
+		for(std::size_t k = 0; k < face.size(); ++k)
+			edge_face[{face[k], face[(k+1) % face.size()]}] = i;
+	}
+
+	// Vertex i is the tool vertex at the start, i + nv the same vertex at the end.
+	std::vector<std::vector<std::size_t>> faces;
+	for(std::size_t i = 0; i < tool.faces.size(); ++i)
+	{
+		auto face = tool.faces[i];
+		if(front[i])
+		{
+			for(auto& v : face)
+				v += nv;
+		}
+		faces.push_back(face);
+	}
+	for(std::size_t i = 0; i < tool.faces.size(); ++i)
+	{
+		if(!front[i])
+			continue;
+		auto& face = tool.faces[i];
+		for(std::size_t k = 0; k < face.size(); ++k)
+		{
+			auto a = face[k];
+			auto b = face[(k+1) % face.size()];
+			if(!front[edge_face.at({b, a})])
+				faces.push_back({a, b, b + nv, a + nv});
+		}
+	}
+
+	// Drop vertices that ended up inside the swept volume
+	mesh::mesh_t sweep;
+	std::vector<std::size_t> index(nv * 2, nv * 2);
+	for(auto& face : faces)
+	{
+		for(auto& v : face)
+		{
+			if(index[v] == nv * 2)
+			{
+				index[v] = sweep.vertices.size();
+				auto& p = tool.vertices[v % nv];
+				sweep.vertices.push_back(v < nv ? p0 + p : p0 + p + d);
+			}
+			v = index[v];
+		}
+	}
+	sweep.faces = std::move(faces);
+	return sweep;
+}
+
+}
+
 geom::polyhedron_t sweep_tool(geom::polyhedron_t tool, const path::step& s0, const path::step& s1)
 {
 	using units::length_mm;
@@ -87,6 +186,199 @@ geom::polyhedron_t sweep_lathe_tool(geom::polyhedron_t tool, const path::step& s
     return geom::rotate(tool, so.R_component_1(), so.R_component_2(), so.R_component_3(), so.R_component_4());
 }
 
+bool make_convex_tool(const geom::polyhedron_t& tool, convex_tool_t& convex)
+{
+	return make_convex_tool(tool, mesh::to_mesh(tool), convex);
+}
+
+bool make_convex_tool(const geom::polyhedron_t& tool, mesh::mesh_t m, convex_tool_t& convex)
+{
+	static const double epsilon = 1e-9;
+
+	if(m.vertices.empty() || m.faces.empty())
+		return false;
+
+	// Closed: every edge is shared with a face traversing it the other way
+	std::map<std::pair<std::size_t, std::size_t>, unsigned> edges;
+	for(auto& face : m.faces)
+	{
+		for(std::size_t k = 0; k < face.size(); ++k)
+			++edges[{face[k], face[(k+1) % face.size()]}];
+	}
+	for(auto& edge : edges)
+	{
+		auto twin = edges.find({edge.first.second, edge.first.first});
+		if(edge.second != 1 || twin == edges.end() || twin->second != 1)
+			return false;
+	}
+
+	auto lo = m.vertices[0];
+	auto hi = m.vertices[0];
+	for(auto& v : m.vertices)
+	{
+		lo = {std::min(lo.x, v.x), std::min(lo.y, v.y), std::min(lo.z, v.z)};
+		hi = {std::max(hi.x, v.x), std::max(hi.y, v.y), std::max(hi.z, v.z)};
+	}
+	auto scale = std::sqrt(dot(hi - lo, hi - lo));
+
+	// Convex: no vertex lies in front of any face plane
+	for(auto& face : m.faces)
+	{
+		auto n = face_normal(m, face);
+		auto nl = std::sqrt(dot(n, n));
+		if(nl == 0)
+			return false;
+		auto& f0 = m.vertices[face[0]];
+		for(auto& v : m.vertices)
+		{
+			if(dot(n, v - f0) > epsilon * nl * scale)
+				return false;
+		}
+	}
+
+	convex.model = tool;
+	convex.mesh = std::move(m);
+	return true;
+}
+
+mesh::mesh_t sweep_mesh(const convex_tool_t& tool, const path::step& s0, const path::step& s1)
+{
+	static const math::quaternion_t identity{1,0,0,0};
+
+	const auto& o0 = s0.orientation;
+	auto start = to_point(s0.position);
+	auto d = to_point(s1.position) - start;
+	if(o0 != identity)
+		return sweep_convex(rotate(tool.mesh, o0), start, d);
+	return sweep_convex(tool.mesh, start, d);
+}
+
+geom::polyhedron_t sweep_tool(const convex_tool_t& tool, const path::step& s0, const path::step& s1)
+{
+	// The hull only holds at fixed orientation; rotary moves take the general sweep
+	if(s0.orientation != s1.orientation || distance(s0.position, s1.position) <= units::length{0.000001 * units::millimeters})
+		return sweep_tool(tool.model, s0, s1);
+
+	// The one conversion geom offers; the OFF text is streamed, never stored
+	return mesh::to_polyhedron(sweep_mesh(tool, s0, s1));
+}
+
+bool check_sweep(const convex_tool_t& tool, const path::step& s0, const path::step& s1)
+{
+	static const double tolerance = 1e-6;
+
+	auto convex_model = sweep_tool(tool, s0, s1);
+	auto glide_model = sweep_tool(tool.model, s0, s1);
+	auto convex = geom::bounding_box(convex_model);
+	auto glide = geom::bounding_box(glide_model);
+	auto equal = [](double a, double b) { return std::abs(a - b) < tolerance; };
+	if(!(equal(convex.min.x, glide.min.x) && equal(convex.min.y, glide.min.y) && equal(convex.min.z, glide.min.z) &&
+		equal(convex.max.x, glide.max.x) && equal(convex.max.y, glide.max.y) && equal(convex.max.z, glide.max.z)))
+		return false;
+
+	// Matching bounds do not catch a missing or extra wedge; the volumes do
+	auto v0 = mesh::volume(mesh::to_mesh(convex_model));
+	auto v1 = mesh::volume(mesh::to_mesh(glide_model));
+	return std::abs(v0 - v1) <= tolerance * std::max(1.0, std::abs(v1));
+}
+
+std::size_t sweep_cache::key_hash::operator()(const key& k) const
+{
+	std::hash<std::int64_t> h;
+	std::size_t seed = std::hash<int>()(k.tool);
+	for(auto q : k.q)
+		seed ^= h(q) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	return seed;
+}
+
+sweep_cache::sweep_cache(std::size_t budget, double quantum)
+ : _budget(budget), _quantum(quantum), _size(0), _hits(0), _misses(0)
+{
+}
+
+geom::polyhedron_t sweep_cache::sweep_tool(int tool, const path::step& s0, const path::step& s1, const sweep_fn& sweep)
+{
+	using units::length_mm;
+
+	auto& p0 = s0.position;
+	auto& p1 = s1.position;
+	auto& o = s0.orientation;
+	double x = length_mm(p0.x).value();
+	double y = length_mm(p0.y).value();
+	double z = length_mm(p0.z).value();
+
+	key k;
+	k.tool = tool;
+	k.q = {{
+		std::llround((length_mm(p1.x).value() - x) / _quantum),
+		std::llround((length_mm(p1.y).value() - y) / _quantum),
+		std::llround((length_mm(p1.z).value() - z) / _quantum),
+		std::llround(o.R_component_1() * 1e9),
+		std::llround(o.R_component_2() * 1e9),
+		std::llround(o.R_component_3() * 1e9),
+		std::llround(o.R_component_4() * 1e9)
+	}};
+
+	auto translated = [&](mesh::mesh_t m)
+	{
+		for(auto& v : m.vertices)
+			v = {v.x + x, v.y + y, v.z + z};
+		return mesh::to_polyhedron(m);
+	};
+
+	/* Entries are plain meshes so that sweeps on different threads never
+	 * share a polyhedron; hits and misses build the result the same way. */
+	std::shared_ptr<const mesh::mesh_t> cached;
+	{
+		std::lock_guard<std::mutex> lock(_m);
+		auto it = _index.find(k);
+		if(it != _index.end())
+		{
+			++_hits;
+			_entries.splice(_entries.begin(), _entries, it->second);
+			cached = it->second->model;
+		}
+		else
+		{
+			++_misses;
+		}
+	}
+	if(cached)
+		return translated(*cached);
+
+	auto a = s0;
+	auto b = s1;
+	a.position.x = a.position.y = a.position.z = units::length{0 * units::millimeters};
+	b.position.x = p1.x - p0.x;
+	b.position.y = p1.y - p0.y;
+	b.position.z = p1.z - p0.z;
+	auto m = std::make_shared<const mesh::mesh_t>(sweep(a, b));
+
+	// The polyhedron built from the mesh is several times its size
+	std::size_t size = m->vertices.size() * sizeof(mesh::point_3) * 16;
+	for(auto& f : m->faces)
+		size += f.size() * sizeof(std::size_t) * 16;
+
+	if(size <= _budget)
+	{
+		std::lock_guard<std::mutex> lock(_m);
+		if(!_index.count(k))
+		{
+			_entries.push_front({k, m, size});
+			_index.emplace(k, _entries.begin());
+			_size += size;
+			while(_size > _budget)
+			{
+				auto& last = _entries.back();
+				_size -= last.size;
+				_index.erase(last.k);
+				_entries.pop_back();
+			}
+		}
+	}
+	return translated(*m);
+}
+
 Bbox bounding_box(const std::vector<path::step>& steps)
 {
 	if(steps.empty())
@@ -98,13 +390,18 @@ Bbox bounding_box(const std::vector<path::step>& steps)
 
 geom::polyhedron_t remove_material(const geom::polyhedron_t& tool, const geom::polyhedron_t& stock, const std::vector<path::step>& steps)
 {
-	auto fold_path = [&tool](std::vector<path::step>::const_iterator begin, std::vector<path::step>::const_iterator end) -> geom::polyhedron_t
+	convex_tool_t convex_tool;
+	bool convex = make_convex_tool(tool, convex_tool);
+
+	auto fold_path = [&](std::vector<path::step>::const_iterator begin, std::vector<path::step>::const_iterator end) -> geom::polyhedron_t
 	{
 		std::vector<geom::polyhedron_t> tool_motion;
 		
 		fold_adjacent(begin, end, std::back_inserter(tool_motion), 
-		[&tool](const path::step& s0, const path::step& s1) -> geom::polyhedron_t
+		[&](const path::step& s0, const path::step& s1) -> geom::polyhedron_t
 		{
+			if(convex)
+				return sweep_tool(convex_tool, s0, s1);
 			return sweep_tool(tool, s0, s1);
 		});
 		
@@ -25,12 +25,21 @@
 #ifndef SIMULATION_H_
 #define SIMULATION_H_
 #include <vector>
+#include <array>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
 #include "cxxcam/Path.h"
 #include "Tool.h"
 #include "Stock.h"
 #include "cxxcam/Units.h"
 #include "cxxcam/Limits.h"
 #include "cxxcam/Bbox.h"
+#include "mesh.h"
 
 namespace cxxcam
 {
@@ -43,6 +52,82 @@ namespace simulation
 geom::polyhedron_t sweep_tool(geom::polyhedron_t tool, const path::step& s0, const path::step& s1);
 geom::polyhedron_t sweep_lathe_tool(geom::polyhedron_t tool, const path::step& s0, const path::step& s1, units::plane_angle spindle_theta);
 
+/*
+ * A convex tool swept linearly at fixed orientation covers the convex hull of
+ * the tool at the start and end points. The hull is built directly from the
+ * tool faces: faces facing away from the motion stay at the start, the rest
+ * move to the end, and the silhouette edges between them are joined by quads.
+ */
+struct convex_tool_t
+{
+	geom::polyhedron_t model;
+	mesh::mesh_t mesh;
+};
+// Returns false if the tool is not a closed convex polyhedron
+bool make_convex_tool(const geom::polyhedron_t& tool, convex_tool_t& convex);
+// As above for a tool whose mesh is already to hand
+bool make_convex_tool(const geom::polyhedron_t& tool, mesh::mesh_t mesh, convex_tool_t& convex);
+// The swept hull as a mesh at the orientation of s0; rotation is applied to
+// the mesh directly. Only valid if s1 has the same orientation.
+mesh::mesh_t sweep_mesh(const convex_tool_t& tool, const path::step& s0, const path::step& s1);
+// Falls back to the general sweep of tool.model if the orientation changes
+geom::polyhedron_t sweep_tool(const convex_tool_t& tool, const path::step& s0, const path::step& s1);
+
+// Compare bounds and volume of the convex sweep and the general glide
+bool check_sweep(const convex_tool_t& tool, const path::step& s0, const path::step& s1);
+
+/*
+ * Swept volumes of repeated relative moves.
+ * A sweep at fixed orientation depends only on the tool, the orientation and
+ * the displacement; it is computed once from the origin and translated to the
+ * start of each later move with the same (quantised) displacement.
+ * Entries are evicted least recently used once the estimated size passes the
+ * budget.
+ */
+class sweep_cache
+{
+public:
+	typedef std::function<mesh::mesh_t(const path::step&, const path::step&)> sweep_fn;
+private:
+	struct key
+	{
+		int tool;
+		std::array<std::int64_t, 7> q;
+		bool operator==(const key& o) const { return tool == o.tool && q == o.q; }
+	};
+	struct key_hash
+	{
+		std::size_t operator()(const key& k) const;
+	};
+	struct entry
+	{
+		key k;
+		std::shared_ptr<const mesh::mesh_t> model;
+		std::size_t size;
+	};
+
+	std::size_t _budget;
+	double _quantum;
+	std::size_t _size;
+	std::list<entry> _entries;
+	std::unordered_map<key, std::list<entry>::iterator, key_hash> _index;
+	std::atomic<std::uint64_t> _hits;
+	std::atomic<std::uint64_t> _misses;
+	std::mutex _m;
+public:
+	// Budget in bytes; displacements are quantised to quantum mm
+	explicit sweep_cache(std::size_t budget, double quantum = 1e-6);
+	sweep_cache(const sweep_cache&) = delete;
+	sweep_cache& operator=(const sweep_cache&) = delete;
+
+	// sweep builds the mesh for the steps moved to the origin on a miss;
+	// safe to call from several threads
+	geom::polyhedron_t sweep_tool(int tool, const path::step& s0, const path::step& s1, const sweep_fn& sweep);
+
+	std::uint64_t hits() const { return _hits; }
+	std::uint64_t misses() const { return _misses; }
+};
+
 // TODO function to iterate path and validate feedrates
 // TODO function to iterate path and calculate time
 
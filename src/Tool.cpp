@@ -25,6 +25,8 @@
 #include "Tool.h"
 #include "geom/primitives.h"
 #include "cxxcam/Error.h"
+#include <cmath>
+#include <algorithm>
 
 namespace cxxcam
 {
@@ -32,18 +34,17 @@ namespace cxxcam
 namespace
 {
 
-geom::polyhedron_t make_mill_tool(const Tool::Mill& em)
+geom::polyhedron_t make_mill_tool(const Tool::Mill& em, double tolerance)
 {
 	using namespace geom;
 
-	// TODO determine slices based on height under arc + accuracy.
-	auto shank = make_cone( {0, 0, em.length}, {0, 0, em.cutting_length}, em.shank_diameter/2, em.shank_diameter/2, 8);
+	auto shank = make_cone( {0, 0, em.length}, {0, 0, em.cutting_length}, em.shank_diameter/2, em.shank_diameter/2, facets(em.shank_diameter, tolerance));
 	
 	switch(em.type)
 	{
 		case Tool::Mill::Type::End:
 		{
-			auto flutes = make_cone( {0, 0, em.cutting_length}, {0, 0, 0}, em.mill_diameter/2, em.mill_diameter/2, 8);
+			auto flutes = make_cone( {0, 0, em.cutting_length}, {0, 0, 0}, em.mill_diameter/2, em.mill_diameter/2, facets(em.mill_diameter, tolerance));
 			return shank + flutes;
 		}
 		default:
@@ -58,13 +59,29 @@ geom::polyhedron_t make_mill_tool(const Tool::Mill& em)
 
 }
 
+int facets(double diameter, double tolerance)
+{
+	static const double PI = 3.14159265358979323846;
+	static const int min_facets = 8;
+	static const int max_facets = 1024;
+
+	auto r = diameter / 2;
+	if(tolerance <= 0 || r <= tolerance)
+		return tolerance <= 0 ? max_facets : min_facets;
+
+	// Chord height of a facet spanning angle a is r(1 - cos(a/2))
+	auto a = 2 * std::acos(1 - tolerance / r);
+	auto n = static_cast<int>(std::ceil(2 * PI / a));
+	return std::max(min_facets, std::min(max_facets, n));
+}
+
 Tool::Tool()
  : m_Name("Invalid")
 {
 }
 
-Tool::Tool(const std::string& name, const Mill& mill)
- : m_Name(name), m_Type(Type::Mill), m_Mill(mill), m_Model(make_mill_tool(m_Mill))
+Tool::Tool(const std::string& name, const Mill& mill, double tolerance)
+ : m_Name(name), m_Type(Type::Mill), m_Mill(mill), m_Model(make_mill_tool(m_Mill, tolerance))
 {
 }
 Tool::Tool(const std::string& name, const Lathe& lathe)
@@ -30,6 +30,12 @@
 namespace cxxcam
 {
 
+/*
+ * Facets needed for a circle of the given diameter so that no chord lies
+ * further than tolerance from the true circle.
+ */
+int facets(double diameter, double tolerance);
+
 /*
  * Representation of the cutting tool used to remove material from the Stock.
  */
@@ -83,7 +89,7 @@ private:
 public:
 	Tool();
 	
-	Tool(const std::string& name, const Mill& mill);
+	Tool(const std::string& name, const Mill& mill, double tolerance = 0.02);
 	Tool(const std::string& name, const Lathe& lathe);
 
 	std::string Name() const;
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * block_sink.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "block_sink.h"
+#include "rs274ngc_return.hh"
+#include "rs274_base.h"
+
+bool block_sink::needs_calls() const {
+    return false;
+}
+
+stream_sink::stream_sink(std::ostream& os)
+ : _os(os) {
+}
+
+void stream_sink::write(const block_t& block, const std::vector<canon::call>&) {
+    _writer.block(block).put('\n').flush(_os);
+}
+
+interp_sink::interp_sink(rs274_base& next)
+ : _next(next), _status(RS274NGC_OK) {
+}
+
+void interp_sink::write(const block_t&, const std::vector<canon::call>& calls) {
+    for (auto& c : calls) {
+        if (_status != RS274NGC_OK)
+            return;
+        _status = _next.replay(c);
+    }
+}
+
+bool interp_sink::needs_calls() const {
+    return true;
+}
+
+int interp_sink::status() const {
+    return _status;
+}
+
+bin_sink::bin_sink(std::ostream& os)
+ : _os(os) {
+}
+
+void bin_sink::write(const block_t&, const std::vector<canon::call>& calls) {
+    if (!_out)
+        _out.reset(new canon::writer(_os));
+    for (auto& c : calls)
+        _out->write(c);
+}
+
+bool bin_sink::needs_calls() const {
+    return true;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * block_sink.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef BLOCK_SINK_H_
+#define BLOCK_SINK_H_
+#include "rs274ngc.hh"
+#include "block_writer.h"
+#include "canon.h"
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+class rs274_base;
+
+/*
+ * Destination for the blocks a filter tool passes on.
+ * Standalone tools write to stdout; nc_pipe chains stages in process.
+ * calls are the canonical calls the block makes, ending with its block_end;
+ * the interpreter only collects them for a sink that needs_calls().
+ */
+class block_sink
+{
+public:
+    virtual void write(const block_t& block, const std::vector<canon::call>& calls) = 0;
+    virtual bool needs_calls() const;
+    virtual ~block_sink() = default;
+};
+
+/* Formats each block as a line of text on the stream. */
+class stream_sink : public block_sink
+{
+private:
+    std::ostream& _os;
+    block_writer _writer;
+public:
+    explicit stream_sink(std::ostream& os);
+    virtual void write(const block_t& block, const std::vector<canon::call>& calls);
+};
+
+/* Feeds each block to the next interpreter in the chain by replaying its
+ * canonical calls (rs274_base::replay), as for binary input; nothing is
+ * formatted or parsed again.
+ * Once the interpreter stops (program end) further blocks are dropped, as
+ * they would be by a downstream process that has exited. */
+class interp_sink : public block_sink
+{
+private:
+    rs274_base& _next;
+    int _status;
+public:
+    explicit interp_sink(rs274_base& next);
+    virtual void write(const block_t& block, const std::vector<canon::call>& calls);
+    virtual bool needs_calls() const;
+
+    int status() const;
+};
+
+/* Writes the binary motion record stream (canon.h): the calls the producing
+ * interpreter made for each block it passes on. Nothing, not even the
+ * stream header, is written before the first block. */
+class bin_sink : public block_sink
+{
+private:
+    std::ostream& _os;
+    std::unique_ptr<canon::writer> _out;
+public:
+    explicit bin_sink(std::ostream& os);
+    virtual void write(const block_t& block, const std::vector<canon::call>& calls);
+    virtual bool needs_calls() const;
+};
+
+#endif /* BLOCK_SINK_H_ */
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * block_writer.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "block_writer.h"
+#include "../r6.h"
+#include <ostream>
+
+block_writer& block_writer::put(char c) {
+    _buffer.push_back(c);
+    return *this;
+}
+block_writer& block_writer::put(const char* s) {
+    _buffer.append(s);
+    return *this;
+}
+
+block_writer& block_writer::word(char address, double value) {
+    char buf[r6_buffer_size];
+    _buffer.push_back(address);
+    _buffer.append(buf, r6(value, buf));
+    _buffer.push_back(' ');
+    return *this;
+}
+block_writer& block_writer::word(char address, unsigned int value) {
+    char buf[16];
+    char* first = buf + sizeof(buf);
+    do {
+        *--first = '0' + value % 10;
+        value /= 10;
+    } while (value);
+
+    _buffer.push_back(address);
+    _buffer.append(first, buf + sizeof(buf));
+    _buffer.push_back(' ');
+    return *this;
+}
+
+block_writer& block_writer::block(const block_t& block) {
+    auto out = [this](char A, const maybe<double>& a){
+        if (a) word(A, *a);
+    };
+    auto outi = [this](char A, const maybe<unsigned int>& a){
+        if (a) word(A, *a);
+    };
+    outi('N', block.line_number);
+
+    for (unsigned i = 0; i < 15; ++i) {
+        if (block.g_modes[i] != -1)
+            word('G', static_cast<double>(block.g_modes[i])/10.0);
+    }
+
+    out('X', block.x);
+    out('Y', block.y);
+    out('Z', block.z);
+    out('A', block.a);
+    out('B', block.b);
+    out('C', block.c);
+
+    outi('H', block.h);
+
+    out('I', block.i);
+    out('J', block.j);
+    out('K', block.k);
+
+    outi('L', block.l);
+
+    out('P', block.p);
+    out('Q', block.q);
+    out('R', block.r);
+    out('S', block.s);
+
+    for (unsigned i = 0; i < 10; ++i) {
+        if (block.m_modes[i] != -1)
+            word('M', static_cast<unsigned int>(block.m_modes[i]));
+    }
+
+    outi('T', block.t);
+    out('D', block.d);
+    out('F', block.f);
+
+    if (block.comment[0]) put('(').put(block.comment).put(") ");
+
+    return *this;
+}
+
+const std::string& block_writer::str() const {
+    return _buffer;
+}
+void block_writer::clear() {
+    _buffer.clear();
+}
+
+void block_writer::flush(std::ostream& os) {
+    os.write(_buffer.data(), _buffer.size());
+    _buffer.clear();
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * block_writer.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef BLOCK_WRITER_H_
+#define BLOCK_WRITER_H_
+#include "rs274ngc.hh"
+#include <string>
+#include <iosfwd>
+
+/*
+ * Formats blocks into a buffer that is reused between blocks, so writing a
+ * block does not allocate once the buffer has grown to the longest line.
+ * Output is identical to str(block).
+ */
+class block_writer
+{
+private:
+    std::string _buffer;
+public:
+    block_writer& put(char c);
+    block_writer& put(const char* s);
+    // Address followed by the value and a space, e.g. "X1.5 "
+    block_writer& word(char address, double value);
+    block_writer& word(char address, unsigned int value);
+    block_writer& block(const block_t& block);
+
+    const std::string& str() const;
+    void clear();
+
+    /* Write the buffered text to the stream and clear the buffer. */
+    void flush(std::ostream& os);
+};
+
+#endif /* BLOCK_WRITER_H_ */
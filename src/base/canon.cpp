@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * canon.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "canon.h"
+#include "input_driver.h"
+#include "../throw_if.h"
+#include <cstring>
+#include <ostream>
+
+namespace canon {
+
+namespace {
+
+// Presence mask bit order of the block words
+maybe<double> block_t::* const real_words[] = {
+    &block_t::a, &block_t::b, &block_t::c, &block_t::d, &block_t::f,
+    &block_t::i, &block_t::j, &block_t::k, &block_t::p, &block_t::q,
+    &block_t::r, &block_t::s, &block_t::x, &block_t::y, &block_t::z
+};
+maybe<unsigned int> block_t::* const integer_words[] = {
+    &block_t::h, &block_t::l, &block_t::t, &block_t::line_number
+};
+const unsigned n_real = sizeof(real_words) / sizeof(*real_words);
+
+}
+
+writer::writer(std::ostream& os)
+ : _os(os) {
+    _record.append(magic, sizeof(magic));
+    put(static_cast<std::int32_t>(version));
+    end();
+}
+
+void writer::begin(op o) {
+    _record.clear();
+    _record.push_back(static_cast<char>(o));
+}
+void writer::put(const void* p, std::size_t n) {
+    _record.append(static_cast<const char*>(p), n);
+}
+void writer::put(double v) {
+    put(&v, sizeof(v));
+}
+void writer::put(std::int32_t v) {
+    put(&v, sizeof(v));
+}
+void writer::put(const Position& p) {
+    double v[] = {p.x, p.y, p.z, p.a, p.b, p.c};
+    put(v, sizeof(v));
+}
+void writer::end() {
+    _os.write(_record.data(), _record.size());
+}
+
+void writer::write(op o) {
+    begin(o);
+    end();
+}
+void writer::write(op o, double value) {
+    begin(o);
+    put(value);
+    end();
+}
+void writer::write(op o, int value) {
+    begin(o);
+    put(static_cast<std::int32_t>(value));
+    end();
+}
+void writer::write(op o, const Position& pos) {
+    begin(o);
+    put(pos);
+    end();
+}
+void writer::arc(double end0, double end1, double axis0, double axis1, int rotation, double end_point, double a, double b, double c) {
+    begin(op::arc);
+    double v[] = {end0, end1, axis0, axis1, end_point, a, b, c};
+    put(v, sizeof(v));
+    put(static_cast<std::int32_t>(rotation));
+    end();
+}
+
+void writer::block(const block_t& block) {
+    begin(op::block_end);
+
+    std::uint32_t mask = 0;
+    for (unsigned w = 0; w < n_real; ++w)
+        if (block.*real_words[w]) mask |= 1u << w;
+    for (unsigned w = 0; w < 4; ++w)
+        if (block.*integer_words[w]) mask |= 1u << (n_real + w);
+    put(&mask, sizeof(mask));
+
+    for (auto w : real_words)
+        if (block.*w) put(*(block.*w));
+    for (auto w : integer_words)
+        if (block.*w) put(static_cast<std::int32_t>(*(block.*w)));
+
+    // Modal groups as (group, value) pairs for the groups present
+    auto modes = [this](const int* m, unsigned n) {
+        std::uint8_t count = 0;
+        for (unsigned g = 0; g < n; ++g)
+            if (m[g] != -1) ++count;
+        put(&count, 1);
+        for (std::uint8_t g = 0; g < n; ++g) {
+            if (m[g] == -1) continue;
+            put(&g, 1);
+            put(static_cast<std::int32_t>(m[g]));
+        }
+    };
+    modes(block.g_modes, 15);
+    modes(block.m_modes, 10);
+    put(static_cast<std::int32_t>(block.motion_to_be));
+
+    std::uint16_t length = ::strnlen(block.comment, sizeof(block.comment) - 1);
+    put(&length, sizeof(length));
+    put(block.comment, length);
+    end();
+}
+
+void writer::write(const call& c) {
+    switch (c.type) {
+        case op::offset_origin:
+        case op::rapid:
+        case op::linear:
+        case op::probe:
+            write(c.type, c.pos);
+            break;
+        case op::rapid_rate:
+        case op::feed_rate:
+        case op::dwell:
+        case op::spindle_speed:
+            write(c.type, c.value);
+            break;
+        case op::units:
+        case op::motion_mode:
+        case op::plane:
+        case op::tool_change:
+            write(c.type, c.integer);
+            break;
+        case op::arc:
+            arc(c.arc[0], c.arc[1], c.arc[2], c.arc[3], c.integer, c.arc[4], c.pos.a, c.pos.b, c.pos.c);
+            break;
+        case op::block_end:
+            block(c.block);
+            break;
+        default:
+            write(c.type);
+            break;
+    }
+}
+
+reader::reader(line_reader& input)
+ : _input(input) {
+    throw_if(!detect(input), "Not a binary toolpath stream");
+    _input.skip(sizeof(magic));
+    auto v = get_int();
+    throw_if(v != static_cast<std::int32_t>(version), "Unsupported binary toolpath version (or byte order)");
+}
+
+bool reader::detect(line_reader& input) {
+    const char* data;
+    return input.peek(sizeof(magic), data) == sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+void reader::get(void* p, std::size_t n) {
+    const char* data;
+    throw_if(_input.peek(n, data) < n, "Truncated binary toolpath stream");
+    std::memcpy(p, data, n);
+    _input.skip(n);
+}
+double reader::get_double() {
+    double v;
+    get(&v, sizeof(v));
+    return v;
+}
+std::int32_t reader::get_int() {
+    std::int32_t v;
+    get(&v, sizeof(v));
+    return v;
+}
+void reader::get(Position& p) {
+    double v[6];
+    get(v, sizeof(v));
+    p.x = v[0]; p.y = v[1]; p.z = v[2];
+    p.a = v[3]; p.b = v[4]; p.c = v[5];
+}
+
+bool reader::next(call& c) {
+    const char* data;
+    if (_input.peek(1, data) == 0)
+        return false;
+    c.type = static_cast<op>(*data);
+    _input.skip(1);
+
+    switch (c.type) {
+        case op::offset_origin:
+        case op::rapid:
+        case op::linear:
+        case op::probe:
+            get(c.pos);
+            break;
+        case op::rapid_rate:
+        case op::feed_rate:
+        case op::dwell:
+        case op::spindle_speed:
+            c.value = get_double();
+            break;
+        case op::units:
+        case op::motion_mode:
+        case op::plane:
+        case op::tool_change:
+            c.integer = get_int();
+            break;
+        case op::arc:
+            get(c.arc, sizeof(c.arc));
+            c.pos.a = get_double();
+            c.pos.b = get_double();
+            c.pos.c = get_double();
+            c.integer = get_int();
+            break;
+        case op::spindle_start_clockwise:
+        case op::spindle_start_counterclockwise:
+        case op::spindle_stop:
+        case op::coolant_flood_on:
+        case op::coolant_flood_off:
+        case op::coolant_mist_on:
+        case op::coolant_mist_off:
+        case op::program_end:
+            break;
+        case op::block_end: {
+            auto& block = c.block;
+            block = block_t();
+
+            std::uint32_t mask;
+            get(&mask, sizeof(mask));
+            for (unsigned w = 0; w < n_real; ++w)
+                if (mask & (1u << w)) block.*real_words[w] = get_double();
+            for (unsigned w = 0; w < 4; ++w)
+                if (mask & (1u << (n_real + w))) block.*integer_words[w] = static_cast<unsigned int>(get_int());
+
+            auto modes = [this](int* m, unsigned n) {
+                std::uint8_t count;
+                get(&count, 1);
+                while (count--) {
+                    std::uint8_t g;
+                    get(&g, 1);
+                    throw_if(g >= n, "Corrupt binary toolpath stream");
+                    m[g] = get_int();
+                }
+            };
+            modes(block.g_modes, 15);
+            modes(block.m_modes, 10);
+            block.motion_to_be = get_int();
+
+            std::uint16_t length;
+            get(&length, sizeof(length));
+            throw_if(length >= sizeof(block.comment), "Corrupt binary toolpath stream");
+            get(block.comment, length);
+            block.comment[length] = 0;
+            break;
+        }
+        default:
+            throw std::runtime_error("Corrupt binary toolpath stream");
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * canon.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef CANON_H_
+#define CANON_H_
+#include "rs274ngc.hh"
+#include <cstdint>
+#include <string>
+#include <iosfwd>
+
+class line_reader;
+
+/*
+ * Binary motion record stream (--format=bin).
+ *
+ * The stream is the sequence of canonical machining calls the interpreter
+ * made, with the words of each block recorded when it ends. Modal state
+ * (units, plane, feed, spindle, tool) is carried by the calls that set it,
+ * motions carry their end point (and arc center), so a reader replays the
+ * stream through rs274_base without parsing G-code.
+ *
+ * Layout: "NCB" 0x1a, uint32 version, then records of a one byte op and its
+ * fixed payload. Values are in host byte order; a reader on a machine of the
+ * other byte order rejects the stream by its version.
+ */
+namespace canon {
+
+const char magic[4] = {'N', 'C', 'B', '\x1a'};
+const std::uint32_t version = 1;
+
+// Values are part of the format; append only
+enum class op : std::uint8_t {
+    offset_origin = 1,
+    units,
+    rapid_rate,
+    rapid,
+    feed_rate,
+    motion_mode,
+    plane,
+    arc,
+    linear,
+    probe,
+    dwell,
+    spindle_start_clockwise,
+    spindle_start_counterclockwise,
+    spindle_speed,
+    spindle_stop,
+    tool_change,
+    coolant_flood_on,
+    coolant_flood_off,
+    coolant_mist_on,
+    coolant_mist_off,
+    program_end,
+    block_end
+};
+
+/* One decoded record. Only the fields of its op are meaningful. */
+struct call {
+    op type;
+    Position pos;
+    // arc: end0, end1, axis0, axis1, end_point
+    double arc[5];
+    double value;
+    int integer;
+    block_t block;
+};
+
+class writer
+{
+private:
+    std::ostream& _os;
+    std::string _record;
+
+    void begin(op o);
+    void put(const void* p, std::size_t n);
+    void put(double v);
+    void put(std::int32_t v);
+    void put(const Position& p);
+    void end();
+public:
+    /* Writes the stream header. */
+    explicit writer(std::ostream& os);
+
+    void write(op o);
+    void write(op o, double value);
+    void write(op o, int value);
+    void write(op o, const Position& pos);
+    void arc(double end0, double end1, double axis0, double axis1, int rotation, double end_point, double a, double b, double c);
+    void block(const block_t& block);
+    /* Any record, e.g. one captured by rs274_base or read back. */
+    void write(const call& c);
+};
+
+class reader
+{
+private:
+    line_reader& _input;
+
+    void get(void* p, std::size_t n);
+    double get_double();
+    std::int32_t get_int();
+    void get(Position& p);
+public:
+    /* Consumes the stream header. */
+    explicit reader(line_reader& input);
+
+    /* True if the input starts with the binary stream magic. */
+    static bool detect(line_reader& input);
+
+    /* Returns false at the end of the stream. */
+    bool next(call& c);
+};
+
+}
+
+#endif /* CANON_H_ */
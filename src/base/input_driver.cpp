@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * input_driver.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "input_driver.h"
+#include "../throw_if.h"
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace po = boost::program_options;
+
+namespace {
+
+const std::size_t block_size = 1 << 20;
+
+}
+
+line_reader::line_reader(const std::string& filename)
+ : _fd(0), _close(false), _map(nullptr), _map_size(0), _eof(false), _pos(nullptr), _end(nullptr) {
+    if (!filename.empty() && filename != "-") {
+        _fd = ::open(filename.c_str(), O_RDONLY);
+        throw_if(_fd < 0, "Unable to open input file: " + filename);
+        _close = true;
+    }
+
+    struct stat st;
+    if (::fstat(_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        _map_size = st.st_size;
+        // Private mapping so that line endings can be overwritten in place
+        auto map = ::mmap(nullptr, _map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _fd, 0);
+        if (map != MAP_FAILED) {
+            _map = static_cast<char*>(map);
+            ::madvise(_map, _map_size, MADV_SEQUENTIAL);
+            _pos = _map;
+            _end = _map + _map_size;
+            _eof = true;
+            return;
+        }
+        _map_size = 0;
+    }
+
+    _block.resize(block_size);
+    _pos = _end = _block.data();
+}
+
+line_reader::~line_reader() {
+    if (_map)
+        ::munmap(_map, _map_size);
+    if (_close)
+        ::close(_fd);
+}
+
+bool line_reader::fill() {
+    if (_eof)
+        return false;
+
+    // Move the partial line to the front, growing if it fills the block
+    auto partial = static_cast<std::size_t>(_end - _pos);
+    std::memmove(_block.data(), _pos, partial);
+    if (partial == _block.size())
+        _block.resize(_block.size() * 2);
+    _pos = _block.data();
+    _end = _pos + partial;
+
+    auto capacity = _block.size() - partial;
+    ssize_t n;
+    do {
+        n = ::read(_fd, _end, capacity);
+    } while (n < 0 && errno == EINTR);
+    throw_if(n < 0, "Unable to read input");
+
+    if (n == 0)
+        _eof = true;
+    _end += n;
+    return n > 0;
+}
+
+bool line_reader::next(const char*& line, std::size_t& length) {
+    while (true) {
+        auto nl = static_cast<char*>(std::memchr(_pos, '\n', _end - _pos));
+        if (nl) {
+            auto first = _pos;
+            _pos = nl + 1;
+            if (nl != first && nl[-1] == '\r')
+                --nl;
+            *nl = 0;
+            line = first;
+            length = nl - first;
+            return true;
+        }
+        if (!fill())
+            break;
+    }
+
+    if (_pos == _end)
+        return false;
+
+    /* Final line without a line ending; a mapping may end exactly on a page
+     * boundary so there is nowhere to terminate it in place. */
+    _tail.assign(_pos, _end);
+    _pos = _end;
+    if (!_tail.empty() && _tail.back() == '\r')
+        _tail.pop_back();
+    line = _tail.c_str();
+    length = _tail.size();
+    return true;
+}
+
+std::size_t line_reader::peek(std::size_t n, const char*& data) {
+    while (static_cast<std::size_t>(_end - _pos) < n && fill())
+        ;
+    data = _pos;
+    return std::min(n, static_cast<std::size_t>(_end - _pos));
+}
+
+void line_reader::skip(std::size_t n) {
+    _pos += std::min(n, static_cast<std::size_t>(_end - _pos));
+}
+
+output_buffer::output_buffer(std::ostream& os, int fd, std::size_t size)
+ : _os(os), _previous(nullptr), _fd(fd), _buffer(size) {
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+    _os.flush();
+    _previous = _os.rdbuf(this);
+}
+
+output_buffer::~output_buffer() {
+    sync();
+    _os.rdbuf(_previous);
+}
+
+bool output_buffer::write_out() {
+    auto p = pbase();
+    auto n = static_cast<std::size_t>(pptr() - p);
+    while (n) {
+        auto w = ::write(_fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= w;
+    }
+    setp(_buffer.data(), _buffer.data() + _buffer.size());
+    return true;
+}
+
+output_buffer::int_type output_buffer::overflow(int_type c) {
+    if (!write_out())
+        return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+int output_buffer::sync() {
+    return write_out() ? 0 : -1;
+}
+
+input_driver::input_driver(const po::variables_map& vm)
+ : _input(vm.count("input") ? vm["input"].as<std::string>() : std::string{}), _output(std::cout, STDOUT_FILENO), _binary(canon::reader::detect(_input)), _output_set(false) {
+    if (vm.count("stats") || vm.count("trace")) {
+        auto trace = vm.count("trace") ? vm["trace"].as<std::string>() : std::string{};
+        _stats.reset(new stats::session(vm.count("stats"), trace));
+    }
+
+    auto format = vm.count("format") ? vm["format"].as<std::string>() : std::string("text");
+    if (format == "bin")
+        _sink.reset(new bin_sink(std::cout));
+    else if (format != "text")
+        throw std::runtime_error("Unknown output format: " + format);
+}
+
+po::options_description input_driver::options() {
+    po::options_description options("input options");
+    options.add_options()
+        ("input", po::value<std::string>()->default_value("-"), "Input file (- for stdin); binary streams are detected")
+    ;
+    options.add(stats::options());
+
+    return options;
+}
+
+po::options_description input_driver::output_options() {
+    po::options_description options("output options");
+    options.add_options()
+        ("format", po::value<std::string>()->default_value("text"), "Output format (text, bin)")
+    ;
+    return options;
+}
+
+line_reader& input_driver::input() {
+    return _input;
+}
+
+bool input_driver::binary() const {
+    return _binary;
+}
+
+void input_driver::output(rs274_base& interp) {
+    if (_sink)
+        interp.output(*_sink);
+    _output_set = true;
+}
+
+int input_driver::run(rs274_base& interp) {
+    if (!_output_set)
+        output(interp);
+    if (_binary)
+        return replay(interp, [](const block_t&) { return true; });
+    return run(interp, [](const char*) { return true; });
+}
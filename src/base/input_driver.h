@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * input_driver.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef INPUT_DRIVER_H_
+#define INPUT_DRIVER_H_
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "rs274_base.h"
+#include "block_writer.h"
+#include "canon.h"
+#include "stats.h"
+#include <boost/program_options.hpp>
+#include <string>
+#include <vector>
+#include <streambuf>
+#include <iostream>
+#include <cstddef>
+#include <memory>
+
+/*
+ * Splits input into lines without copying.
+ * Regular files are mapped privately and each line is terminated in place;
+ * pipes and terminals are read in large blocks.
+ */
+class line_reader
+{
+private:
+    int _fd;
+    bool _close;
+    char* _map;
+    std::size_t _map_size;
+
+    std::vector<char> _block;
+    bool _eof;
+
+    char* _pos;
+    char* _end;
+    std::string _tail;
+
+    bool fill();
+public:
+    /* Reads stdin if filename is empty or "-". */
+    explicit line_reader(const std::string& filename);
+    line_reader(const line_reader&) = delete;
+    line_reader& operator=(const line_reader&) = delete;
+    ~line_reader();
+
+    /* Next line, null terminated and without the line ending.
+     * Valid until the following call. Returns false at the end of input. */
+    bool next(const char*& line, std::size_t& length);
+
+    /* Raw access for binary input. Makes up to n bytes available at data
+     * and returns how many there are (fewer only at the end of input). */
+    std::size_t peek(std::size_t n, const char*& data);
+    void skip(std::size_t n);
+};
+
+/*
+ * Large write buffer installed in place of the stream buffer of os for its
+ * lifetime, writing directly to the file descriptor.
+ */
+class output_buffer : public std::streambuf
+{
+private:
+    std::ostream& _os;
+    std::streambuf* _previous;
+    int _fd;
+    std::vector<char> _buffer;
+
+    bool write_out();
+protected:
+    virtual int_type overflow(int_type c);
+    virtual int sync();
+public:
+    output_buffer(std::ostream& os, int fd, std::size_t size = 1 << 20);
+    output_buffer(const output_buffer&) = delete;
+    output_buffer& operator=(const output_buffer&) = delete;
+    ~output_buffer();
+};
+
+/*
+ * Feeds each line of the --input file (or stdin) to the interpreter, with
+ * std::cout buffered until the driver is destroyed.
+ * Input starting with the binary stream magic is replayed instead of parsed.
+ * For filters (output_options()) --format=bin writes the blocks the tool
+ * passes on as a binary stream.
+ * --stats / --trace report for the lifetime of the driver.
+ */
+class input_driver
+{
+private:
+    std::unique_ptr<stats::session> _stats;
+    line_reader _input;
+    output_buffer _output;
+    bool _binary;
+    std::unique_ptr<bin_sink> _sink;
+    bool _output_set;
+    block_writer _text;
+
+    template <typename Fn>
+    int replay(rs274_base& interp, Fn fn) {
+        canon::reader reader(_input);
+        canon::call c;
+        while (true) {
+            {
+                stats::scope timer(stats::section::read);
+                if (!reader.next(c))
+                    break;
+            }
+            int status;
+            {
+                stats::scope timer(stats::section::execute);
+                status = interp.replay(c);
+            }
+            if (c.type != canon::op::block_end)
+                continue;
+            if (status != RS274NGC_OK)
+                return status;
+            if (!fn(c.block))
+                break;
+        }
+        return RS274NGC_OK;
+    }
+public:
+    explicit input_driver(const boost::program_options::variables_map& vm);
+
+    static boost::program_options::options_description options();
+    /* --format, for tools that pass blocks on rather than printing their
+     * own output. */
+    static boost::program_options::options_description output_options();
+
+    line_reader& input();
+    /* True if the input is a binary stream. */
+    bool binary() const;
+
+    /* Send the blocks interp passes on in the selected --format.
+     * run() does this for the interpreter it is given unless called first. */
+    void output(rs274_base& interp);
+
+    /* Read and execute each line, calling fn(line) after each one executes.
+     * Stops early if fn returns false. Returns the interpreter status.
+     * For binary input fn is given each block formatted as text. */
+    template <typename Fn>
+    int run(rs274_base& interp, Fn fn) {
+        if (!_output_set)
+            output(interp);
+
+        if (_binary) {
+            return replay(interp, [&](const block_t& block) {
+                _text.clear();
+                _text.block(block);
+                return fn(_text.str().c_str());
+            });
+        }
+
+        const char* line;
+        std::size_t length;
+        while (_input.next(line, length)) {
+            int status;
+            {
+                stats::scope timer(stats::section::read);
+                status = interp.read(line);
+            }
+            if (status != RS274NGC_OK && status != RS274NGC_EXECUTE_FINISH) {
+                std::cerr << "Error reading line!: \n";
+                std::cerr << line << "\n";
+                return status;
+            }
+
+            {
+                stats::scope timer(stats::section::execute);
+                status = interp.execute();
+            }
+            if (status != RS274NGC_OK)
+                return status;
+            if (!fn(line))
+                break;
+        }
+        return RS274NGC_OK;
+    }
+    int run(rs274_base& interp);
+};
+
+#endif /* INPUT_DRIVER_H_ */
@@ -59,6 +59,50 @@ void get_machine(lua::state& L, const std::string& name) {
     pop_machine_field.disarm();
 }
 
+// Read the tool entry at the top of the stack
+void read_tool(lua::state& L, machine_config::mill_tool& tool) {
+    lua_getfield(L, -1, "name");
+    if(lua_isstring(L, -1))
+        tool.name = lua_tostring(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "length");
+    if(lua_isnumber(L, -1))
+        tool.length = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "diameter");
+    if(lua_isnumber(L, -1))
+        tool.diameter = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "flutes");
+    if(lua_isnumber(L, -1))
+        tool.flutes = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "flute_length");
+    if(lua_isnumber(L, -1))
+        tool.flute_length = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "shank_diameter");
+    if(lua_isnumber(L, -1))
+        tool.shank_diameter = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+}
+void read_tool(lua::state& L, machine_config::lathe_tool& tool) {
+    lua_getfield(L, -1, "name");
+    if(lua_isstring(L, -1))
+        tool.name = lua_tostring(L, -1);
+    lua_pop(L, 1);
+
+    lua_getfield(L, -1, "nose_radius");
+    if(lua_isnumber(L, -1))
+        tool.nose_radius = lua_tonumber(L, -1);
+    lua_pop(L, 1);
+}
+
 }
 
 namespace machine_config {
@@ -174,36 +218,7 @@ bool get_tool(nc_config& config, unsigned id, const std::string& machine, mill_t
     if (lua_isnil(L, -1)) return false;
     throw_if (!lua_istable(L, -1), "tool entry incorrect");
     
-    lua_getfield(L, -1, "name");
-    if(lua_isstring(L, -1))
-        tool.name = lua_tostring(L, -1);
-    lua_pop(L, 1);
-
-    lua_getfield(L, -1, "length");
-    if(lua_isnumber(L, -1))
-        tool.length = lua_tonumber(L, -1);
-    lua_pop(L, 1);
-
-    lua_getfield(L, -1, "diameter");
-    if(lua_isnumber(L, -1))
-        tool.diameter = lua_tonumber(L, -1);
-    lua_pop(L, 1);
-
-    lua_getfield(L, -1, "flutes");
-    if(lua_isnumber(L, -1))
-        tool.flutes = lua_tonumber(L, -1);
-    lua_pop(L, 1);
-
-    lua_getfield(L, -1, "flute_length");
-    if(lua_isnumber(L, -1))
-        tool.flute_length = lua_tonumber(L, -1);
-    lua_pop(L, 1);
-
-    lua_getfield(L, -1, "shank_diameter");
-    if(lua_isnumber(L, -1))
-        tool.shank_diameter = lua_tonumber(L, -1);
-    lua_pop(L, 1);
-
+    read_tool(L, tool);
     return true;
 }
 
@@ -215,4 +230,56 @@ bool get_tool(nc_config& config, unsigned id, const std::string& machine, lathe_
     return false;
 }
 
+machine_profile get_profile(nc_config& config, const std::string& machine) {
+    machine_profile profile;
+    profile.length_units = machine_units(config, machine);
+    profile.type = get_machine_type(config, machine);
+
+    if (machine == "__default__")
+        return profile;
+
+    auto& L = config.state();
+    get_machine(L, machine);
+    auto pop_machine_field = make_guard([&]{ lua_pop(L, 1); });
+
+    lua_getfield(L, -1, "tool_table");
+    auto pop_tool_table = make_guard([&]{ lua_pop(L, 1); });
+    if (lua_isnil(L, -1)) return profile;
+    throw_if (!lua_istable(L, -1), "tool_table missing / incorrect");
+
+    lua_pushnil(L);
+    while (lua_next(L, -2)) {
+        auto pop_tool_entry = make_guard([&]{ lua_pop(L, 1); });
+        // Tools are looked up by slot number; other keys were never reachable
+        if (lua_type(L, -2) != LUA_TNUMBER) continue;
+        throw_if (!lua_istable(L, -1), "tool entry incorrect");
+
+        unsigned id = lua_tointeger(L, -2);
+        switch (profile.type) {
+            case machine_type::mill:
+                read_tool(L, profile.mill_tools[id]);
+                break;
+            case machine_type::lathe:
+                read_tool(L, profile.lathe_tools[id]);
+                break;
+        }
+    }
+
+    return profile;
+}
+
+bool get_tool(const machine_profile& profile, unsigned id, mill_tool& tool) {
+    auto it = profile.mill_tools.find(id);
+    if (it == profile.mill_tools.end()) return false;
+    tool = it->second;
+    return true;
+}
+
+bool get_tool(const machine_profile& profile, unsigned id, lathe_tool& tool) {
+    auto it = profile.lathe_tools.find(id);
+    if (it == profile.lathe_tools.end()) return false;
+    tool = it->second;
+    return true;
+}
+
 }
@@ -25,6 +25,7 @@
 #ifndef MACHINE_CONFIG_H_
 #define MACHINE_CONFIG_H_
 #include <string>
+#include <map>
 #include "nc_config.h"
 #include <boost/program_options.hpp>
 
@@ -57,11 +58,25 @@ struct mill_tool {
 };
 struct lathe_tool {
     std::string name;
+    double nose_radius = 0.4;
 };
 
 bool get_tool(nc_config& config, unsigned id, const std::string& machine, mill_tool& tool);
 bool get_tool(nc_config& config, unsigned id, const std::string& machine, lathe_tool& tool);
 
+/* Machine settings resolved once from the configuration so that code called
+ * per point or per move never has to query the Lua state. */
+struct machine_profile {
+    units length_units = units::metric;
+    machine_type type = machine_type::mill;
+    std::map<unsigned, mill_tool> mill_tools;
+    std::map<unsigned, lathe_tool> lathe_tools;
+};
+machine_profile get_profile(nc_config& config, const std::string& machine);
+
+bool get_tool(const machine_profile& profile, unsigned id, mill_tool& tool);
+bool get_tool(const machine_profile& profile, unsigned id, lathe_tool& tool);
+
 }
 
 #endif /* MACHINE_CONFIG_H_ */
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * motion_steps.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "motion_steps.h"
+#include <cmath>
+#include <algorithm>
+
+namespace motion {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+void to_mm(const cxxcam::Position& p, double* out) {
+    using cxxcam::units::length_mm;
+    out[0] = length_mm(p.X).value();
+    out[1] = length_mm(p.Y).value();
+    out[2] = length_mm(p.Z).value();
+}
+
+cxxcam::math::point_3 to_point(const double* p) {
+    using namespace cxxcam::units;
+    return {length{p[0] * millimeters}, length{p[1] * millimeters}, length{p[2] * millimeters}};
+}
+
+std::size_t segments(double length, int steps_per_mm) {
+    if (steps_per_mm <= 0)
+        return 1;
+    return std::max(1.0, std::ceil(length * steps_per_mm));
+}
+
+}
+
+orientation_span::orientation_span(const cxxcam::Position& start, const cxxcam::Position& end)
+ : _start(start), _end(end), _rotates(start.A != end.A || start.B != end.B || start.C != end.C), _resolved(false) {
+}
+
+cxxcam::math::quaternion_t orientation_span::orientation(const cxxcam::Position& p) const {
+    // The rotary axis convention belongs to cxxcam; ask it for the end of a move to p
+    return cxxcam::path::expand_linear(_start, p, {}, -1).path.back().orientation;
+}
+
+cxxcam::math::quaternion_t orientation_span::at(double t) const {
+    if (!_resolved) {
+        _q0 = orientation(_start);
+        _q1 = orientation(_end);
+        _resolved = true;
+    }
+    if (t <= 0 || !_rotates)
+        return _q0;
+    if (t >= 1)
+        return _q1;
+
+    /* Rotary axes move linearly in their own values, as the steps of
+     * expand_linear do; a turn of 180 degrees or more, or a whole turn that
+     * ends where it started, is followed the long way round. */
+    auto p = _start;
+    p.A = _start.A + (_end.A - _start.A) * t;
+    p.B = _start.B + (_end.B - _start.B) * t;
+    p.C = _start.C + (_end.C - _start.C) * t;
+    return orientation(p);
+}
+
+linear_steps::linear_steps(const cxxcam::Position& start, const cxxcam::Position& end, int steps_per_mm)
+ : _orientation(start, end) {
+    double p1[3];
+    to_mm(start, _p0);
+    to_mm(end, p1);
+    for (unsigned k = 0; k < 3; ++k)
+        _d[k] = p1[k] - _p0[k];
+    _segments = segments(std::sqrt(_d[0]*_d[0] + _d[1]*_d[1] + _d[2]*_d[2]), steps_per_mm);
+}
+
+cxxcam::math::point_3 linear_steps::position(std::size_t i) const {
+    double t = static_cast<double>(i) / _segments;
+    double p[] = {_p0[0] + _d[0] * t, _p0[1] + _d[1] * t, _p0[2] + _d[2] * t};
+    return to_point(p);
+}
+
+cxxcam::path::step linear_steps::step(std::size_t i) const {
+    cxxcam::path::step s;
+    s.position = position(i);
+    s.orientation = _orientation.at(static_cast<double>(i) / _segments);
+    return s;
+}
+
+arc_steps::arc_steps(const cxxcam::Position& start, const cxxcam::Position& end, const cxxcam::Position& center, cxxcam::path::ArcDirection dir, const cxxcam::math::vector_3& plane, double turns, int steps_per_mm)
+ : _orientation(start, end) {
+    // (u, v, w) right handed with w along the plane normal
+    if (plane.x != 0) {
+        _u = 1; _v = 2; _w = 0;
+    } else if (plane.y != 0) {
+        _u = 2; _v = 0; _w = 1;
+    } else {
+        _u = 0; _v = 1; _w = 2;
+    }
+
+    double s[3];
+    double c[3];
+    to_mm(start, s);
+    to_mm(end, _end);
+    to_mm(center, c);
+
+    _center[0] = c[_u];
+    _center[1] = c[_v];
+    _r0 = std::hypot(s[_u] - c[_u], s[_v] - c[_v]);
+    _dr = std::hypot(_end[_u] - c[_u], _end[_v] - c[_v]) - _r0;
+    _theta0 = std::atan2(s[_v] - c[_v], s[_u] - c[_u]);
+    auto theta1 = std::atan2(_end[_v] - c[_v], _end[_u] - c[_u]);
+    _w0 = s[_w];
+    _dw = _end[_w] - s[_w];
+
+    // Coincident start and end is a full circle
+    auto extra = 2 * PI * std::max(0.0, std::floor(turns) - 1);
+    if (dir == cxxcam::path::ArcDirection::CounterClockwise) {
+        _sweep = theta1 - _theta0;
+        if (_sweep <= 0) _sweep += 2 * PI;
+        _sweep += extra;
+    } else {
+        _sweep = theta1 - _theta0;
+        if (_sweep >= 0) _sweep -= 2 * PI;
+        _sweep -= extra;
+    }
+
+    // Step count from the arc length as cxxcam has it, turns and helix included
+    auto length = cxxcam::path::length_arc(start, end, center, dir, plane, turns);
+    _segments = segments(cxxcam::units::length_mm(length).value(), steps_per_mm);
+}
+
+cxxcam::math::point_3 arc_steps::position(std::size_t i) const {
+    if (i >= _segments)
+        return to_point(_end);
+
+    double t = static_cast<double>(i) / _segments;
+    auto theta = _theta0 + _sweep * t;
+    auto r = _r0 + _dr * t;
+    double p[3];
+    p[_u] = _center[0] + r * std::cos(theta);
+    p[_v] = _center[1] + r * std::sin(theta);
+    p[_w] = _w0 + _dw * t;
+    return to_point(p);
+}
+
+void arc_steps::bounds(cxxcam::math::point_3& min, cxxcam::math::point_3& max) const {
+    double lo[3];
+    double hi[3];
+    auto add = [&](const double* p) {
+        for (unsigned k = 0; k < 3; ++k) {
+            lo[k] = std::min(lo[k], p[k]);
+            hi[k] = std::max(hi[k], p[k]);
+        }
+    };
+    auto at = [&](double theta, double* p) {
+        auto t = (theta - _theta0) / _sweep;
+        auto r = _r0 + _dr * t;
+        p[_u] = _center[0] + r * std::cos(theta);
+        p[_v] = _center[1] + r * std::sin(theta);
+        p[_w] = _w0 + _dw * t;
+    };
+
+    double p[3];
+    at(_theta0, p);
+    std::copy(p, p + 3, lo);
+    std::copy(p, p + 3, hi);
+    add(_end);
+
+    /* Extrema along u and v lie at multiples of a quarter turn. The radius
+     * varies monotonically so of several turns only the first and last
+     * crossing of each direction can be extreme. */
+    auto first = std::min(_theta0, _theta0 + _sweep);
+    auto last = std::max(_theta0, _theta0 + _sweep);
+    for (unsigned q = 0; q < 4; ++q) {
+        auto phi = q * PI / 2;
+        auto k0 = std::ceil((first - phi) / (2 * PI));
+        auto k1 = std::floor((last - phi) / (2 * PI));
+        if (k0 > k1)
+            continue;
+        at(phi + 2 * PI * k0, p);
+        add(p);
+        at(phi + 2 * PI * k1, p);
+        add(p);
+    }
+
+    min = to_point(lo);
+    max = to_point(hi);
+}
+
+cxxcam::path::step arc_steps::step(std::size_t i) const {
+    cxxcam::path::step s;
+    s.position = position(i);
+    s.orientation = _orientation.at(static_cast<double>(i) / _segments);
+    return s;
+}
+
+}
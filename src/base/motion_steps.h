@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * motion_steps.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef MOTION_STEPS_H_
+#define MOTION_STEPS_H_
+#include "cxxcam/Path.h"
+#include "cxxcam/Position.h"
+#include "cxxcam/Math.h"
+#include <cstddef>
+#include <iterator>
+
+/*
+ * Steps along a motion computed on demand, in place of the step vectors of
+ * cxxcam::path::expand_linear / expand_arc. Positions cost a few flops and no
+ * allocation. Orientation is only resolved if step() is called, and only
+ * costs a call into cxxcam per step when a rotary axis moves.
+ */
+namespace motion {
+
+struct position_of {
+    typedef cxxcam::math::point_3 type;
+    template <typename Steps>
+    type operator()(const Steps& s, std::size_t i) const { return s.position(i); }
+};
+struct step_of {
+    typedef cxxcam::path::step type;
+    template <typename Steps>
+    type operator()(const Steps& s, std::size_t i) const { return s.step(i); }
+};
+
+template <typename Steps, typename Get>
+class step_iterator
+{
+private:
+    const Steps* _steps;
+    std::size_t _i;
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename Get::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    typedef value_type reference;
+
+    step_iterator(const Steps* steps, std::size_t i) : _steps(steps), _i(i) {}
+    value_type operator*() const { return Get()(*_steps, _i); }
+    step_iterator& operator++() { ++_i; return *this; }
+    step_iterator operator++(int) { auto it = *this; ++_i; return it; }
+    bool operator==(const step_iterator& o) const { return _i == o._i; }
+    bool operator!=(const step_iterator& o) const { return _i != o._i; }
+};
+
+template <typename It>
+struct range {
+    It first;
+    It last;
+    It begin() const { return first; }
+    It end() const { return last; }
+};
+
+/* Orientation along a motion. The endpoints are resolved by cxxcam on first
+ * use; between them the rotary axis values are interpolated and converted by
+ * cxxcam at each step. */
+class orientation_span
+{
+private:
+    cxxcam::Position _start;
+    cxxcam::Position _end;
+    bool _rotates;
+    mutable bool _resolved;
+    mutable cxxcam::math::quaternion_t _q0;
+    mutable cxxcam::math::quaternion_t _q1;
+
+    cxxcam::math::quaternion_t orientation(const cxxcam::Position& p) const;
+public:
+    orientation_span(const cxxcam::Position& start, const cxxcam::Position& end);
+    cxxcam::math::quaternion_t at(double t) const;
+};
+
+/* Iteration over positions by default; steps() for position and orientation. */
+template <typename Steps>
+class steps_base
+{
+private:
+    const Steps& self() const { return static_cast<const Steps&>(*this); }
+public:
+    typedef step_iterator<Steps, position_of> position_iterator;
+    typedef step_iterator<Steps, step_of> iterator;
+
+    position_iterator begin() const { return {&self(), 0}; }
+    position_iterator end() const { return {&self(), self().size()}; }
+    range<iterator> steps() const { return {{&self(), 0}, {&self(), self().size()}}; }
+};
+
+class linear_steps : public steps_base<linear_steps>
+{
+private:
+    orientation_span _orientation;
+    double _p0[3];
+    double _d[3];
+    std::size_t _segments;
+public:
+    /* steps_per_mm <= 0 yields the endpoints only. */
+    linear_steps(const cxxcam::Position& start, const cxxcam::Position& end, int steps_per_mm = -1);
+
+    std::size_t size() const { return _segments + 1; }
+    cxxcam::math::point_3 position(std::size_t i) const;
+    cxxcam::path::step step(std::size_t i) const;
+};
+
+/* The number of steps comes from cxxcam::path::length_arc so that it follows
+ * cxxcam's handling of direction, full circles and turns. */
+class arc_steps : public steps_base<arc_steps>
+{
+private:
+    orientation_span _orientation;
+    // Axes of the arc plane (u, v) and its normal (w) as indices into xyz
+    unsigned _u, _v, _w;
+    double _center[2];
+    double _r0;
+    double _dr;
+    double _theta0;
+    double _sweep;
+    double _w0;
+    double _dw;
+    double _end[3];
+    std::size_t _segments;
+public:
+    arc_steps(const cxxcam::Position& start, const cxxcam::Position& end, const cxxcam::Position& center, cxxcam::path::ArcDirection dir, const cxxcam::math::vector_3& plane, double turns, int steps_per_mm = 10);
+
+    std::size_t size() const { return _segments + 1; }
+    cxxcam::math::point_3 position(std::size_t i) const;
+    cxxcam::path::step step(std::size_t i) const;
+
+    /* Signed angle swept about the plane normal, radians. */
+    double sweep() const { return _sweep; }
+
+    /* Exact axis aligned bounds: the endpoints and every point where the
+     * sweep crosses an axis direction of the plane. */
+    void bounds(cxxcam::math::point_3& min, cxxcam::math::point_3& max) const;
+};
+
+}
+
+#endif /* MOTION_STEPS_H_ */
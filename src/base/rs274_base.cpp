@@ -25,70 +25,33 @@
 #include "rs274_base.h"
 #include <cmath>
 #include <cstring>
+#include <iostream>
 #include <lua.hpp>
-#include "../r6.h"
-#include <sstream>
 #include "machine_config.h"
+#include "block_writer.h"
+#include "rs274ngc_return.hh"
+#include "stats.h"
 
 namespace po = boost::program_options;
 
 std::string str(const block_t& block)
 {
-    std::ostringstream s;
-    auto out = [&s](char A, maybe<double> a){
-        if (a) s << A << r6(*a) << ' ';
-    };
-    auto outi = [&s](char A, maybe<unsigned int> a){
-        if (a) s << A << r6(*a) << ' ';
-    };
-    outi('N', block.line_number);
-
-    for (unsigned i = 0; i < 15; ++i) {
-        if (block.g_modes[i] != -1)
-            out('G', static_cast<double>(block.g_modes[i])/10.0);
-    }
-
-    out('X', block.x);
-    out('Y', block.y);
-    out('Z', block.z);
-    out('A', block.a);
-    out('B', block.b);
-    out('C', block.c);
-
-    outi('H', block.h);
-
-    out('I', block.i);
-    out('J', block.j);
-    out('K', block.k);
-
-    outi('L', block.l);
-
-    out('P', block.p);
-    out('Q', block.q);
-    out('R', block.r);
-    out('S', block.s);
-
-    for (unsigned i = 0; i < 10; ++i) {
-        if (block.m_modes[i] != -1)
-            outi('M', block.m_modes[i]);
-    }
-
-    outi('T', block.t);
-    out('D', block.d);
-    out('F', block.f);
-
-    if (block.comment[0]) s << "(" << block.comment << ") ";
-
-    return s.str();
+    block_writer w;
+    w.block(block);
+    return w.str();
 }
 
-rs274_base::rs274_base(po::variables_map& vm)
- : config(vm["config"].as<std::string>()), machine_id()
+rs274_base::rs274_base(const po::variables_map& vm)
+ : _stdout_sink(std::cout), _sink(&_stdout_sink), _record(false), _replay_end(false), config(vm["config"].as<std::string>()), machine_id()
 {
-    if (vm.count("machine"))
-        machine_id = vm["machine"].as<std::string>();
-    else
-        machine_id = machine_config::default_machine(config);
+    {
+        stats::scope timer(stats::section::lua);
+        if (vm.count("machine"))
+            machine_id = vm["machine"].as<std::string>();
+        else
+            machine_id = machine_config::default_machine(config);
+        machine = machine_config::get_profile(config, machine_id);
+    }
 
 	init();
 }
@@ -96,6 +59,115 @@ rs274_base::~rs274_base()
 {
 }
 
+void rs274_base::output(block_sink& sink)
+{
+    _sink = &sink;
+    _record = sink.needs_calls();
+}
+void rs274_base::emit(const block_t& block)
+{
+    emit(block, _calls);
+}
+void rs274_base::emit(const block_t& block, const std::vector<canon::call>& calls)
+{
+    stats::scope timer(stats::section::output);
+    _sink->write(block, calls);
+}
+bool rs274_base::recording() const
+{
+    return _record;
+}
+const std::vector<canon::call>& rs274_base::calls() const
+{
+    return _calls;
+}
+canon::call& rs274_base::record(canon::op type)
+{
+    _calls.emplace_back();
+    auto& c = _calls.back();
+    c.type = type;
+    return c;
+}
+
+int rs274_base::replay(const canon::call& c)
+{
+    using canon::op;
+    switch (c.type) {
+        case op::offset_origin:
+            offset_origin(c.pos);
+            break;
+        case op::units:
+            units(static_cast<Units>(c.integer));
+            break;
+        case op::rapid_rate:
+            rapid_rate(c.value);
+            break;
+        case op::rapid:
+            rapid(c.pos);
+            break;
+        case op::feed_rate:
+            feed_rate(c.value);
+            break;
+        case op::motion_mode:
+            motion_mode(static_cast<Motion>(c.integer));
+            break;
+        case op::plane:
+            plane(static_cast<Plane>(c.integer));
+            break;
+        case op::arc:
+            arc(c.arc[0], c.arc[1], c.arc[2], c.arc[3], c.integer, c.arc[4], c.pos.a, c.pos.b, c.pos.c);
+            break;
+        case op::linear:
+            linear(c.pos);
+            break;
+        case op::probe:
+            probe(c.pos);
+            break;
+        case op::dwell:
+            dwell(c.value);
+            break;
+        case op::spindle_start_clockwise:
+            spindle_start_clockwise();
+            break;
+        case op::spindle_start_counterclockwise:
+            spindle_start_counterclockwise();
+            break;
+        case op::spindle_speed:
+            spindle_speed(c.value);
+            break;
+        case op::spindle_stop:
+            spindle_stop();
+            break;
+        case op::tool_change:
+            tool_change(c.integer);
+            break;
+        case op::coolant_flood_on:
+            coolant_flood_on();
+            break;
+        case op::coolant_flood_off:
+            coolant_flood_off();
+            break;
+        case op::coolant_mist_on:
+            coolant_mist_on();
+            break;
+        case op::coolant_mist_off:
+            coolant_mist_off();
+            break;
+        case op::program_end:
+            program_end();
+            _replay_end = true;
+            break;
+        case op::block_end:
+            block_end(c.block);
+            if (_replay_end) {
+                _replay_end = false;
+                return RS274NGC_EXIT;
+            }
+            break;
+    }
+    return RS274NGC_OK;
+}
+
 cxxcam::Position rs274_base::convert(const Position& p) const
 {
     using namespace cxxcam;
@@ -161,7 +233,7 @@ void rs274_base::interp_init()
 	_traverse_rate = 60;
     _spindle_theta = 0;
 
-    switch (machine_config::machine_units(config, machine_id)) {
+    switch (machine.length_units) {
         case machine_config::units::metric:
             _length_unit_type = Units::Metric;
             break;
@@ -175,6 +247,7 @@ void rs274_base::interp_init()
 
 void rs274_base::offset_origin(const Position& pos)
 {
+    if (_record) record(canon::op::offset_origin).pos = pos;
     program_pos = program_pos + origin_pos - pos;
     origin_pos = pos;
 }
@@ -182,6 +255,7 @@ void rs274_base::offset_origin(const Position& pos)
 
 void rs274_base::units(Units u)
 {
+    if (_record) record(canon::op::units).integer = static_cast<int>(u);
     if (u == Units::Imperial)
     {
         if (_length_unit_type == Units::Metric)
@@ -212,18 +286,24 @@ void rs274_base::units(Units u)
 
 void rs274_base::rapid_rate(double rate)
 {
+    if (_record) record(canon::op::rapid_rate).value = rate;
     _traverse_rate = rate;
 }
 
 void rs274_base::rapid(const Position& pos)
 {
-    _rapid(pos);
+    if (_record) record(canon::op::rapid).pos = pos;
+    {
+        stats::scope timer(stats::section::rapid);
+        _rapid(pos);
+    }
     program_pos = pos;
 }
 
 
 void rs274_base::feed_rate(double rate)
 {
+    if (_record) record(canon::op::feed_rate).value = rate;
     _feed_rate = rate;
 }
 
@@ -235,12 +315,14 @@ void rs274_base::feed_reference(FeedReference)
 
 void rs274_base::motion_mode(Motion mode)
 {
+    if (_record) record(canon::op::motion_mode).integer = static_cast<int>(mode);
     _motion_mode = mode;
 }
 
 
 void rs274_base::plane(Plane pl)
 {
+    if (_record) record(canon::op::plane).integer = static_cast<int>(pl);
     _active_plane = pl;
 }
 
@@ -268,6 +350,18 @@ void rs274_base::speed_feed_sync_stop()
 
 void rs274_base::arc(double end0, double end1, double axis0, double axis1, int rotation, double end_point, double a, double b, double c)
 {
+    if (_record) {
+        auto& r = record(canon::op::arc);
+        r.arc[0] = end0;
+        r.arc[1] = end1;
+        r.arc[2] = axis0;
+        r.arc[3] = axis1;
+        r.arc[4] = end_point;
+        r.integer = rotation;
+        r.pos.a = a;
+        r.pos.b = b;
+        r.pos.c = c;
+    }
     Position end;
     Position center;
     cxxcam::math::vector_3 plane;
@@ -302,7 +396,10 @@ void rs274_base::arc(double end0, double end1, double axis0, double axis1, int r
     end.b = b;
     end.c = c;
 
-    _arc(end, center, plane, rotation);
+    {
+        stats::scope timer(stats::section::arc);
+        _arc(end, center, plane, rotation);
+    }
 
     if (_active_plane == Plane::XY)
     {
@@ -330,12 +427,17 @@ void rs274_base::arc(double end0, double end1, double axis0, double axis1, int r
 
 void rs274_base::linear(const Position& pos)
 {
-    _linear(pos);
+    if (_record) record(canon::op::linear).pos = pos;
+    {
+        stats::scope timer(stats::section::linear);
+        _linear(pos);
+    }
     program_pos = pos;
 }
 
 void rs274_base::probe(const Position& pos)
 {
+    if (_record) record(canon::op::probe).pos = pos;
     double distance;
     double dx, dy, dz;
     double backoff;
@@ -359,24 +461,28 @@ void rs274_base::probe(const Position& pos)
 }
 
 
-void rs274_base::dwell(double)
+void rs274_base::dwell(double seconds)
 {
+    if (_record) record(canon::op::dwell).value = seconds;
 }
 
 void rs274_base::spindle_start_clockwise()
 {
+    if (_record) record(canon::op::spindle_start_clockwise);
     _spindle_turning = ((_spindle_speed == 0) ? Direction::Stop : Direction::Clockwise);
 }
 
 
 void rs274_base::spindle_start_counterclockwise()
 {
+    if (_record) record(canon::op::spindle_start_counterclockwise);
     _spindle_turning = ((_spindle_speed == 0) ? Direction::Stop : Direction::CounterClockwise);
 }
 
 
 void rs274_base::spindle_speed(double r)
 {
+    if (_record) record(canon::op::spindle_speed).value = r;
     _spindle_speed = r;
 }
 
@@ -388,6 +494,7 @@ double rs274_base::spindle_mode() const {
 
 void rs274_base::spindle_stop()
 {
+    if (_record) record(canon::op::spindle_stop);
     _spindle_turning = Direction::Stop;
 }
 
@@ -403,6 +510,7 @@ void rs274_base::tool_length_offset(double)
 
 void rs274_base::tool_change(int slot)
 {
+    if (_record) record(canon::op::tool_change).integer = slot;
     _active_slot = slot;
 }
 
@@ -438,12 +546,14 @@ void rs274_base::speed_override_enable()
 
 void rs274_base::coolant_flood_off()
 {
+    if (_record) record(canon::op::coolant_flood_off);
     _flood = 0;
 }
 
 
 void rs274_base::coolant_flood_on()
 {
+    if (_record) record(canon::op::coolant_flood_on);
     _flood = 1;
 }
 
@@ -454,12 +564,14 @@ void rs274_base::message(const char *)
 
 void rs274_base::coolant_mist_off()
 {
+    if (_record) record(canon::op::coolant_mist_off);
     _mist = 0;
 }
 
 
 void rs274_base::coolant_mist_on()
 {
+    if (_record) record(canon::op::coolant_mist_on);
     _mist = 1;
 }
 
@@ -491,6 +603,8 @@ void rs274_base::program_optional_stop()
 
 void rs274_base::program_end()
 {
+    if (_record) record(canon::op::program_end);
+    _program_end();
 }
 
 double rs274_base::feed_rate() const
@@ -559,17 +673,17 @@ Tool rs274_base::tool(int pocket) const
 
     Tool tool;
     tool.id = pocket;
-    switch (get_machine_type(config, machine_id)) {
+    switch (machine.type) {
         case machine_type::mill: {
             mill_tool t;
-            get_tool(config, pocket, machine_id, t);
+            get_tool(machine, pocket, t);
             tool.length = t.length;
             tool.diameter = t.diameter;
             break;
         }
         case machine_type::lathe: {
             lathe_tool t;
-            get_tool(config, pocket, machine_id, t);
+            get_tool(machine, pocket, t);
             // TODO
             break;
         }
@@ -582,7 +696,19 @@ double rs274_base::rapid_rate() const
     return _traverse_rate;
 }
 
-void rs274_base::block_end(const block_t&)
+void rs274_base::block_end(const block_t& block)
+{
+    if (_record) record(canon::op::block_end).block = block;
+    {
+        stats::scope timer(stats::section::block_end);
+        _block_end(block);
+    }
+    _calls.clear();
+}
+void rs274_base::_block_end(const block_t&)
+{
+}
+void rs274_base::_program_end()
 {
 }
 
@@ -29,7 +29,11 @@
 #include "cxxcam/Math.h"
 #include "lua/state.h"
 #include <string>
+#include <vector>
 #include "nc_config.h"
+#include "machine_config.h"
+#include "block_sink.h"
+#include "canon.h"
 #include <boost/program_options.hpp>
 
 std::string str(const block_t& block);
@@ -37,14 +41,32 @@ std::string str(const block_t& block);
 class rs274_base : public rs274ngc
 {
 public:
-	rs274_base(boost::program_options::variables_map& vm);
+	rs274_base(const boost::program_options::variables_map& vm);
 	virtual ~rs274_base();
+
+    /* Send blocks passed on by this tool to sink instead of stdout. */
+    void output(block_sink& sink);
+
+    /* Apply a canonical call read from a binary stream as if the
+     * interpreter had made it. Returns RS274NGC_EXIT at the end of the
+     * block that ended the program. */
+    int replay(const canon::call& c);
 private:
 	virtual void interp_init();
 
+    stream_sink _stdout_sink;
+    block_sink* _sink;
+    bool _record;
+    std::vector<canon::call> _calls;
+    bool _replay_end;
+
+    /* Append a canonical call to those of the current block. */
+    canon::call& record(canon::op type);
+
 protected:
     mutable nc_config config;
     std::string machine_id;
+    machine_config::machine_profile machine;
 
 	Plane               _active_plane = Plane::XY;
 	int                 _active_slot = 1;
@@ -66,6 +88,15 @@ protected:
     cxxcam::Position convert(const Position& p) const;
     double spindle_delta_theta(const cxxcam::units::length& motion_length) const;
     void apply_spindle_delta(double delta_theta);
+    /* Pass on block, as made by the calls of the block being ended. */
+    void emit(const block_t& block);
+    /* Pass on block made by calls, for blocks this tool changes or adds. */
+    void emit(const block_t& block, const std::vector<canon::call>& calls);
+    /* True if the sink needs the canonical calls of each block passed on. */
+    bool recording() const;
+    /* The stateful canonical calls made so far for the current block,
+     * ending with its block_end once ended. Empty unless recording(). */
+    const std::vector<canon::call>& calls() const;
 private:
 
 	virtual void offset_origin(const Position& pos);
@@ -134,6 +165,8 @@ private:
 	virtual Tool tool(int pocket) const;
 	virtual double rapid_rate() const;
     virtual void block_end(const block_t& block);
+    virtual void _block_end(const block_t& block);
+    virtual void _program_end();
 };
 
 #endif /* RS274_BASE_H_ */
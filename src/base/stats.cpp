@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stats.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "stats.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+
+namespace po = boost::program_options;
+
+namespace stats {
+
+session* active = nullptr;
+
+namespace {
+
+const char* names[] = {
+    "read",
+    "execute",
+    "rapid",
+    "linear",
+    "arc",
+    "block_end",
+    "output",
+    "lua"
+};
+
+// Bounds trace memory; totals are still counted past this
+const std::size_t max_events = 4000000;
+
+double us(clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+}
+
+session::session(bool summary, const std::string& trace)
+ : _summary(summary), _trace(trace), _start(clock::now()), _totals(), _dropped(0) {
+    active = this;
+}
+
+session::~session() {
+    if (active == this)
+        active = nullptr;
+    try {
+        if (_summary)
+            write_summary();
+        if (!_trace.empty())
+            write_trace();
+    } catch (const std::exception& e) {
+        std::cerr << "stats: " << e.what() << "\n";
+    }
+}
+
+void session::add(section id, clock::time_point start, clock::time_point end) {
+    auto& t = _totals[static_cast<unsigned>(id)];
+    ++t.calls;
+    t.time += end - start;
+    if (_trace.empty())
+        return;
+    if (_events.size() < max_events)
+        _events.push_back({id, start, end - start});
+    else
+        ++_dropped;
+}
+
+void session::counter(const std::string& name, std::uint64_t value) {
+    for (auto& c : _counters) {
+        if (c.first == name) {
+            c.second = value;
+            return;
+        }
+    }
+    _counters.emplace_back(name, value);
+}
+
+void session::write_summary() const {
+    auto wall = clock::now() - _start;
+    std::cerr << std::left << std::setw(12) << "section" << std::right
+              << std::setw(14) << "calls"
+              << std::setw(14) << "total ms"
+              << std::setw(12) << "mean us" << "\n";
+    for (unsigned i = 0; i < static_cast<unsigned>(section::count); ++i) {
+        auto& t = _totals[i];
+        if (!t.calls) continue;
+        std::cerr << std::left << std::setw(12) << names[i] << std::right
+                  << std::setw(14) << t.calls
+                  << std::setw(14) << std::fixed << std::setprecision(3) << us(t.time) / 1000
+                  << std::setw(12) << std::setprecision(3) << us(t.time) / t.calls << "\n";
+    }
+    std::cerr << std::left << std::setw(12) << "wall" << std::right
+              << std::setw(28) << std::fixed << std::setprecision(3) << us(wall) / 1000 << "\n";
+    for (auto& c : _counters)
+        std::cerr << std::left << std::setw(26) << c.first << std::right << std::setw(14) << c.second << "\n";
+    if (_dropped)
+        std::cerr << _dropped << " trace events dropped\n";
+}
+
+void session::write_trace() const {
+    std::ofstream os(_trace);
+    if (!os)
+        throw std::runtime_error("Unable to write trace file: " + _trace);
+
+    os << "{\"traceEvents\":[\n";
+    os << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (auto& e : _events) {
+        if (!first) os << ",\n";
+        first = false;
+        os << "{\"name\":\"" << names[static_cast<unsigned>(e.id)] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+           << ",\"ts\":" << us(e.start - _start) << ",\"dur\":" << us(e.time) << "}";
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+po::options_description options() {
+    po::options_description options("stats options");
+    options.add_options()
+        ("stats", "Print hot path call counts and times to stderr at exit")
+        ("trace", po::value<std::string>(), "Write a Chrome trace-event file")
+    ;
+
+    return options;
+}
+
+}
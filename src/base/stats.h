@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stats.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+/*
+ * Counters and timers around the interpreter hot paths (--stats, --trace).
+ * A scope costs one branch when no session is active. Sections may nest
+ * (output includes downstream stages in nc_pipe); times are inclusive.
+ * Only the interpreter thread is instrumented.
+ */
+namespace stats {
+
+enum class section : unsigned {
+    read,
+    execute,
+    rapid,
+    linear,
+    arc,
+    block_end,
+    output,
+    lua,
+    count
+};
+
+typedef std::chrono::steady_clock clock;
+
+class session
+{
+private:
+    struct total {
+        std::uint64_t calls;
+        clock::duration time;
+    };
+    struct event {
+        section id;
+        clock::time_point start;
+        clock::duration time;
+    };
+
+    bool _summary;
+    std::string _trace;
+    clock::time_point _start;
+    total _totals[static_cast<unsigned>(section::count)];
+    std::vector<event> _events;
+    std::uint64_t _dropped;
+    std::vector<std::pair<std::string, std::uint64_t>> _counters;
+
+    void write_summary() const;
+    void write_trace() const;
+public:
+    /* Print a summary to stderr and / or write a Chrome trace-event file
+     * (empty for none) when the session ends. */
+    session(bool summary, const std::string& trace);
+    session(const session&) = delete;
+    session& operator=(const session&) = delete;
+    ~session();
+
+    void add(section id, clock::time_point start, clock::time_point end);
+
+    /* Tool specific count reported with the summary. */
+    void counter(const std::string& name, std::uint64_t value);
+};
+
+// Current session, if any
+extern session* active;
+
+class scope
+{
+private:
+    session* _session;
+    section _id;
+    clock::time_point _start;
+public:
+    explicit scope(section id)
+     : _session(active), _id(id) {
+        if (_session) _start = clock::now();
+    }
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+    ~scope() {
+        if (_session) _session->add(_id, _start, clock::now());
+    }
+};
+
+boost::program_options::options_description options();
+
+}
+
+#endif /* STATS_H_ */
@@ -42,4 +42,20 @@ OutputIt fold_adjacent(InputIt first, InputIt last, OutputIt d_first, BinaryOper
 	return ++d_first;
 }
 
+template<class InputIt, class BinaryFunction>
+BinaryFunction for_each_adjacent(InputIt first, InputIt last, BinaryFunction fn)
+{
+	if (first == last)
+		return fn;
+
+	auto acc = *first;
+	while (++first != last)
+	{
+		auto val = *first;
+		fn(acc, val);
+		acc = std::move(val);
+	}
+	return fn;
+}
+
 #endif /* FOLD_ADJACENT_H_ */
@@ -0,0 +1,820 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mesh.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "mesh.h"
+#include "geom/io.h"
+#include "throw_if.h"
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <cctype>
+#include <array>
+#include <stdexcept>
+
+namespace mesh
+{
+
+namespace
+{
+
+// Skip whitespace and '#' comments
+std::istream& skip(std::istream& is)
+{
+	while(is)
+	{
+		is >> std::ws;
+		if(is.peek() != '#')
+			break;
+		is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	}
+	return is;
+}
+
+bool big_endian()
+{
+	const std::uint16_t one = 1;
+	char c;
+	std::memcpy(&c, &one, 1);
+	return c == 0;
+}
+
+// Little endian binary values regardless of the host byte order
+template <typename T>
+void put(std::ostream& os, T value)
+{
+	char b[sizeof(T)];
+	std::memcpy(b, &value, sizeof(T));
+	if(big_endian())
+		std::reverse(b, b + sizeof(T));
+	os.write(b, sizeof(T));
+}
+
+template <typename T>
+bool get(std::istream& is, T& value, bool swap)
+{
+	char b[sizeof(T)];
+	if(!is.read(b, sizeof(T)))
+		return false;
+	if(swap)
+		std::reverse(b, b + sizeof(T));
+	std::memcpy(&value, b, sizeof(T));
+	return true;
+}
+
+struct ply_property
+{
+	std::string name;
+	std::string type;
+	std::string count_type;		// Set for list properties
+};
+
+struct ply_element
+{
+	std::string name;
+	std::size_t count;
+	std::vector<ply_property> properties;
+};
+
+bool read_ply_value(std::istream& is, const std::string& type, bool swap, double& value)
+{
+	if(type == "char" || type == "int8") { std::int8_t x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "uchar" || type == "uint8") { std::uint8_t x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "short" || type == "int16") { std::int16_t x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "ushort" || type == "uint16") { std::uint16_t x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "int" || type == "int32") { std::int32_t x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "uint" || type == "uint32") { std::uint32_t x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "float" || type == "float32") { float x; if(!get(is, x, swap)) return false; value = x; }
+	else if(type == "double" || type == "float64") { double x; if(!get(is, x, swap)) return false; value = x; }
+	else return false;
+	return true;
+}
+
+}
+
+point_3 newell_normal(const std::vector<point_3>& vertices, const std::vector<std::size_t>& face)
+{
+	point_3 n = {0, 0, 0};
+	for(std::size_t i = 0; i < face.size(); ++i)
+	{
+		auto& a = vertices[face[i]];
+		auto& b = vertices[face[(i + 1) % face.size()]];
+		n.x += (a.y - b.y) * (a.z + b.z);
+		n.y += (a.z - b.z) * (a.x + b.x);
+		n.z += (a.x - b.x) * (a.y + b.y);
+	}
+	return n;
+}
+
+void triangulate(const std::vector<point_3>& vertices, const std::vector<std::size_t>& face, std::vector<std::size_t>& triangles)
+{
+	triangles.clear();
+	auto n = face.size();
+	auto fan = [&]
+	{
+		triangles.clear();
+		for(std::size_t k = 1; k + 1 < n; ++k)
+			triangles.insert(triangles.end(), {face[0], face[k], face[k + 1]});
+	};
+	if(n <= 3)
+	{
+		fan();
+		return;
+	}
+
+	// Newell normal picks the projection and the winding
+	auto normal = newell_normal(vertices, face);
+	auto ax = std::abs(normal.x), ay = std::abs(normal.y), az = std::abs(normal.z);
+	int drop = (ax >= ay && ax >= az) ? 0 : (ay >= az ? 1 : 2);
+	double sign = (drop == 0 ? normal.x : (drop == 1 ? normal.y : normal.z)) < 0 ? -1 : 1;
+	auto u = [&](std::size_t i) { auto& p = vertices[i]; return drop == 0 ? p.y : (drop == 1 ? p.z : p.x); };
+	auto v = [&](std::size_t i) { auto& p = vertices[i]; return drop == 0 ? p.z : (drop == 1 ? p.x : p.y); };
+	auto area = [&](std::size_t a, std::size_t b, std::size_t c)
+	{
+		return sign * ((u(b) - u(a)) * (v(c) - v(a)) - (v(b) - v(a)) * (u(c) - u(a)));
+	};
+
+	std::vector<std::size_t> ring(face);
+	while(ring.size() > 3)
+	{
+		bool clipped = false;
+		for(std::size_t i = 0; i < ring.size() && !clipped; ++i)
+		{
+			auto a = ring[(i + ring.size() - 1) % ring.size()];
+			auto b = ring[i];
+			auto c = ring[(i + 1) % ring.size()];
+			if(area(a, b, c) <= 0)
+				continue;
+			bool ear = true;
+			for(auto p : ring)
+			{
+				if(p == a || p == b || p == c)
+					continue;
+				if(area(a, b, p) >= 0 && area(b, c, p) >= 0 && area(c, a, p) >= 0)
+				{
+					ear = false;
+					break;
+				}
+			}
+			if(!ear)
+				continue;
+			triangles.insert(triangles.end(), {a, b, c});
+			ring.erase(ring.begin() + i);
+			clipped = true;
+		}
+		if(!clipped)
+		{
+			fan();
+			return;
+		}
+	}
+	triangles.insert(triangles.end(), ring.begin(), ring.end());
+}
+
+bool read_off(std::istream& is, mesh_t& mesh)
+{
+	std::string header;
+	if(!(skip(is) >> header) || header.size() < 3 || header.compare(header.size() - 3, 3, "OFF") != 0)
+		return false;
+
+	std::size_t nv, nf, ne;
+	if(!(skip(is) >> nv >> nf >> ne))
+		return false;
+
+	mesh.vertices.resize(nv);
+	for(auto& v : mesh.vertices)
+	{
+		if(!(skip(is) >> v.x >> v.y >> v.z))
+			return false;
+		is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	}
+
+	mesh.faces.resize(nf);
+	for(auto& f : mesh.faces)
+	{
+		std::size_t n;
+		if(!(skip(is) >> n))
+			return false;
+		f.resize(n);
+		for(auto& i : f)
+		{
+			if(!(is >> i) || i >= nv)
+				return false;
+		}
+		// Discard optional face colour
+		is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+	}
+	return true;
+}
+
+void write_off(std::ostream& os, const mesh_t& mesh)
+{
+	auto precision = os.precision(std::numeric_limits<double>::max_digits10);
+	os << "OFF\n" << mesh.vertices.size() << " " << mesh.faces.size() << " 0\n";
+	for(auto& v : mesh.vertices)
+		os << v.x << " " << v.y << " " << v.z << "\n";
+	for(auto& f : mesh.faces)
+	{
+		os << f.size();
+		for(auto i : f)
+			os << " " << i;
+		os << "\n";
+	}
+	os.precision(precision);
+}
+
+bool read_stl(std::istream& is, mesh_t& mesh)
+{
+	char header[80];
+	std::uint32_t count;
+	if(!is.read(header, sizeof(header)) || !get(is, count, big_endian()))
+		return false;
+
+	// Corners are welded on their exact single precision coordinates
+	struct key_hash
+	{
+		std::size_t operator()(const std::array<std::uint32_t, 3>& k) const
+		{
+			return (std::size_t(k[0]) * 73856093) ^ (std::size_t(k[1]) * 19349663) ^ (std::size_t(k[2]) * 83492791);
+		}
+	};
+	std::unordered_map<std::array<std::uint32_t, 3>, std::size_t, key_hash> index;
+
+	mesh.vertices.clear();
+	mesh.faces.clear();
+	mesh.faces.reserve(count);
+	for(std::uint32_t t = 0; t < count; ++t)
+	{
+		float f[12];
+		std::uint16_t attribute;
+		for(auto& x : f)
+			if(!get(is, x, big_endian()))
+				return false;
+		if(!get(is, attribute, big_endian()))
+			return false;
+
+		std::vector<std::size_t> face;
+		for(int c = 0; c < 3; ++c)
+		{
+			auto p = f + 3 + c * 3;
+			std::array<std::uint32_t, 3> k;
+			std::memcpy(k.data(), p, sizeof(k));
+			auto it = index.find(k);
+			if(it == index.end())
+			{
+				it = index.emplace(k, mesh.vertices.size()).first;
+				mesh.vertices.push_back({p[0], p[1], p[2]});
+			}
+			face.push_back(it->second);
+		}
+		// Triangles with coincident corners carry no area
+		if(face[0] != face[1] && face[1] != face[2] && face[2] != face[0])
+			mesh.faces.push_back(std::move(face));
+	}
+	return true;
+}
+
+void write_stl(std::ostream& os, const mesh_t& mesh)
+{
+	char header[80] = "nc_tools binary STL";
+	os.write(header, sizeof(header));
+
+	std::uint32_t count = 0;
+	for(auto& f : mesh.faces)
+		count += f.size() >= 3 ? f.size() - 2 : 0;
+	put(os, count);
+
+	std::vector<std::size_t> triangles;
+	for(auto& f : mesh.faces)
+	{
+		if(f.size() < 3)
+			continue;
+		triangulate(mesh.vertices, f, triangles);
+		for(std::size_t t = 0; t < triangles.size(); t += 3)
+		{
+			auto& a = mesh.vertices[triangles[t]];
+			auto& b = mesh.vertices[triangles[t + 1]];
+			auto& c = mesh.vertices[triangles[t + 2]];
+			auto n = cross(b - a, c - a);
+			auto len = std::sqrt(n.x*n.x + n.y*n.y + n.z*n.z);
+			if(len > 0)
+				n = {n.x / len, n.y / len, n.z / len};
+			for(auto& p : {n, a, b, c})
+			{
+				put(os, static_cast<float>(p.x));
+				put(os, static_cast<float>(p.y));
+				put(os, static_cast<float>(p.z));
+			}
+			put(os, std::uint16_t(0));
+		}
+	}
+}
+
+bool read_ply(std::istream& is, mesh_t& mesh)
+{
+	std::string line;
+	if(!std::getline(is, line) || line.compare(0, 3, "ply") != 0)
+		return false;
+
+	bool swap = false;
+	bool have_format = false;
+	std::vector<ply_element> elements;
+	while(std::getline(is, line))
+	{
+		if(!line.empty() && line.back() == '\r')
+			line.pop_back();
+		std::istringstream s(line);
+		std::string keyword;
+		s >> keyword;
+		if(keyword == "format")
+		{
+			std::string type;
+			s >> type;
+			if(type == "binary_little_endian")
+				swap = big_endian();
+			else if(type == "binary_big_endian")
+				swap = !big_endian();
+			else
+				return false;
+			have_format = true;
+		}
+		else if(keyword == "element")
+		{
+			ply_element e;
+			if(!(s >> e.name >> e.count))
+				return false;
+			elements.push_back(e);
+		}
+		else if(keyword == "property")
+		{
+			if(elements.empty())
+				return false;
+			ply_property p;
+			if(!(s >> p.type))
+				return false;
+			if(p.type == "list" && !(s >> p.count_type >> p.type))
+				return false;
+			if(!(s >> p.name))
+				return false;
+			elements.back().properties.push_back(p);
+		}
+		else if(keyword == "end_header")
+			break;
+	}
+	if(!have_format || !is)
+		return false;
+
+	mesh.vertices.clear();
+	mesh.faces.clear();
+	for(auto& e : elements)
+	{
+		bool vertex = e.name == "vertex";
+		bool face = e.name == "face";
+		if(vertex)
+			mesh.vertices.reserve(e.count);
+		if(face)
+			mesh.faces.reserve(e.count);
+
+		for(std::size_t i = 0; i < e.count; ++i)
+		{
+			point_3 p = {0, 0, 0};
+			std::vector<std::size_t> indices;
+			for(auto& prop : e.properties)
+			{
+				double value;
+				if(prop.count_type.empty())
+				{
+					if(!read_ply_value(is, prop.type, swap, value))
+						return false;
+					if(vertex && prop.name == "x") p.x = value;
+					else if(vertex && prop.name == "y") p.y = value;
+					else if(vertex && prop.name == "z") p.z = value;
+					continue;
+				}
+
+				double n;
+				if(!read_ply_value(is, prop.count_type, swap, n) || n < 0)
+					return false;
+				bool keep = face && (prop.name == "vertex_indices" || prop.name == "vertex_index");
+				for(std::size_t k = 0; k < static_cast<std::size_t>(n); ++k)
+				{
+					if(!read_ply_value(is, prop.type, swap, value))
+						return false;
+					if(keep)
+						indices.push_back(static_cast<std::size_t>(value));
+				}
+			}
+			if(vertex)
+				mesh.vertices.push_back(p);
+			if(face)
+				mesh.faces.push_back(std::move(indices));
+		}
+	}
+
+	for(auto& f : mesh.faces)
+		for(auto i : f)
+			if(i >= mesh.vertices.size())
+				return false;
+	return true;
+}
+
+void write_ply(std::ostream& os, const mesh_t& mesh)
+{
+	std::size_t largest = 0;
+	for(auto& f : mesh.faces)
+		largest = std::max(largest, f.size());
+	bool small = largest <= std::numeric_limits<std::uint8_t>::max();
+
+	os << "ply\n"
+	   << "format binary_little_endian 1.0\n"
+	   << "comment nc_tools\n"
+	   << "element vertex " << mesh.vertices.size() << "\n"
+	   << "property double x\n"
+	   << "property double y\n"
+	   << "property double z\n"
+	   << "element face " << mesh.faces.size() << "\n"
+	   << "property list " << (small ? "uchar" : "uint") << " int vertex_indices\n"
+	   << "end_header\n";
+
+	for(auto& v : mesh.vertices)
+	{
+		put(os, v.x);
+		put(os, v.y);
+		put(os, v.z);
+	}
+	for(auto& f : mesh.faces)
+	{
+		if(small)
+			put(os, static_cast<std::uint8_t>(f.size()));
+		else
+			put(os, static_cast<std::uint32_t>(f.size()));
+		for(auto i : f)
+			put(os, static_cast<std::int32_t>(i));
+	}
+}
+
+format parse_format(const std::string& name)
+{
+	if(name == "off")
+		return format::off;
+	if(name == "stl")
+		return format::stl;
+	if(name == "ply")
+		return format::ply;
+	throw std::runtime_error("Unknown mesh format: " + name);
+}
+
+format format_of(const std::string& filename, format fallback)
+{
+	auto dot = filename.find_last_of("./");
+	if(dot == std::string::npos || filename[dot] != '.')
+		return fallback;
+	auto ext = filename.substr(dot + 1);
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return std::tolower(c); });
+	if(ext == "off" || ext == "stl" || ext == "ply")
+		return parse_format(ext);
+	return fallback;
+}
+
+bool read(std::istream& is, mesh_t& mesh, format f)
+{
+	switch(f)
+	{
+		case format::off:
+			return read_off(is, mesh);
+		case format::stl:
+			return read_stl(is, mesh);
+		case format::ply:
+			return read_ply(is, mesh);
+	}
+	return false;
+}
+
+void write(std::ostream& os, const mesh_t& mesh, format f)
+{
+	switch(f)
+	{
+		case format::off:
+			write_off(os, mesh);
+			break;
+		case format::stl:
+			write_stl(os, mesh);
+			break;
+		case format::ply:
+			write_ply(os, mesh);
+			break;
+	}
+}
+
+bool read(std::istream& is, geom::polyhedron_t& poly, format f)
+{
+	if(f == format::off)
+		return static_cast<bool>(is >> geom::format::off >> poly);
+
+	mesh_t mesh;
+	if(!read(is, mesh, f))
+		return false;
+	off_source source(mesh);
+	std::istream s(&source);
+	return static_cast<bool>(s >> geom::format::off >> poly);
+}
+
+bool read(std::istream& is, geom::object_t& object, format f)
+{
+	if(f == format::off)
+		return static_cast<bool>(is >> object);
+
+	mesh_t mesh;
+	if(!read(is, mesh, f))
+		return false;
+	off_source source(mesh);
+	std::istream s(&source);
+	return static_cast<bool>(s >> object);
+}
+
+void write(std::ostream& os, const geom::polyhedron_t& poly, format f)
+{
+	if(f == format::off)
+	{
+		os << geom::format::off << poly;
+		return;
+	}
+	write(os, to_mesh(poly), f);
+}
+
+double volume(const mesh_t& mesh)
+{
+	// Divergence theorem over a fan of each face; planar faces need no ear clipping
+	double v = 0;
+	for(auto& f : mesh.faces)
+	{
+		for(std::size_t k = 1; k + 1 < f.size(); ++k)
+		{
+			auto& a = mesh.vertices[f[0]];
+			auto& b = mesh.vertices[f[k]];
+			auto& c = mesh.vertices[f[k + 1]];
+			auto n = cross(b, c);
+			v += a.x*n.x + a.y*n.y + a.z*n.z;
+		}
+	}
+	return v / 6;
+}
+
+mesh_t to_mesh(const geom::polyhedron_t& poly)
+{
+	mesh_t mesh;
+	off_sink sink(mesh);
+	std::ostream s(&sink);
+	s << std::setprecision(std::numeric_limits<double>::max_digits10) << geom::format::off << poly;
+	throw_if(!sink.finish(), "Unable to read polyhedron mesh");
+	return mesh;
+}
+
+std::size_t face_count(const geom::polyhedron_t& poly)
+{
+	mesh_t mesh;
+	off_sink sink(mesh, true);
+	std::ostream s(&sink);
+	s << geom::format::off << poly;
+	throw_if(!sink.finish(), "Unable to read polyhedron mesh");
+	return sink.faces();
+}
+
+geom::polyhedron_t to_polyhedron(const mesh_t& mesh)
+{
+	off_source source(mesh);
+	std::istream s(&source);
+
+	geom::polyhedron_t poly;
+	throw_if(!(s >> geom::format::off >> poly), "Unable to create polyhedron from mesh");
+	return poly;
+}
+
+off_sink::off_sink(mesh_t& mesh, bool counts_only)
+ : _mesh(mesh), _state(state::header), _vertices(0), _faces(0), _good(true), _counts_only(counts_only)
+{
+	_mesh.vertices.clear();
+	_mesh.faces.clear();
+}
+
+off_sink::int_type off_sink::overflow(int_type c)
+{
+	if(traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+	auto ch = traits_type::to_char_type(c);
+	xsputn(&ch, 1);
+	return c;
+}
+
+std::streamsize off_sink::xsputn(const char* s, std::streamsize n)
+{
+	if(_state == state::done)
+		return n;
+	auto end = s + n;
+	while(s != end)
+	{
+		auto nl = static_cast<const char*>(std::memchr(s, '\n', end - s));
+		if(!nl)
+		{
+			_line.append(s, end);
+			break;
+		}
+		_line.append(s, nl);
+		parse_line();
+		_line.clear();
+		s = nl + 1;
+	}
+	return n;
+}
+
+void off_sink::parse_line()
+{
+	auto comment = _line.find('#');
+	if(comment != std::string::npos)
+		_line.resize(comment);
+
+	auto p = _line.c_str();
+	auto skip = [&]
+	{
+		while(*p == ' ' || *p == '\t' || *p == '\r')
+			++p;
+		return *p != 0;
+	};
+	auto number = [&](std::size_t& value)
+	{
+		char* end;
+		value = std::strtoul(p, &end, 10);
+		if(end == p)
+			return false;
+		p = end;
+		return true;
+	};
+
+	while(_good && _state != state::done && skip())
+	{
+		switch(_state)
+		{
+			case state::header:
+			{
+				auto start = p;
+				while(*p && *p != ' ' && *p != '\t' && *p != '\r')
+					++p;
+				std::string header(start, p);
+				_good = header.size() >= 3 && header.compare(header.size() - 3, 3, "OFF") == 0;
+				_state = state::counts;
+				continue;
+			}
+			case state::counts:
+			{
+				std::size_t edges;
+				_good = number(_vertices) && skip() && number(_faces) && skip() && number(edges);
+				if(_counts_only)
+				{
+					_state = state::done;
+					return;
+				}
+				_mesh.vertices.reserve(_vertices);
+				_mesh.faces.reserve(_faces);
+				_state = _vertices ? state::vertices : (_faces ? state::faces : state::done);
+				return;
+			}
+			case state::vertices:
+			{
+				double v[3];
+				for(auto& x : v)
+				{
+					char* end;
+					x = std::strtod(p, &end);
+					_good = _good && end != p;
+					p = end;
+				}
+				_mesh.vertices.push_back({v[0], v[1], v[2]});
+				if(_mesh.vertices.size() == _vertices)
+					_state = _faces ? state::faces : state::done;
+				return;
+			}
+			case state::faces:
+			{
+				std::size_t n;
+				_good = number(n);
+				std::vector<std::size_t> face(_good ? n : 0);
+				for(auto& i : face)
+					_good = _good && skip() && number(i) && i < _vertices;
+				// Anything after the indices is a face colour
+				_mesh.faces.push_back(std::move(face));
+				if(_mesh.faces.size() == _faces)
+					_state = state::done;
+				return;
+			}
+			case state::done:
+				return;
+		}
+	}
+}
+
+bool off_sink::finish()
+{
+	if(!_line.empty())
+	{
+		parse_line();
+		_line.clear();
+	}
+	return _good && _state == state::done;
+}
+
+off_source::off_source(const mesh_t& mesh)
+ : _mesh(mesh), _line(0)
+{
+}
+
+off_source::int_type off_source::underflow()
+{
+	if(gptr() < egptr())
+		return traits_type::to_int_type(*gptr());
+
+	auto nv = _mesh.vertices.size();
+	auto nf = _mesh.faces.size();
+	if(_line > nv + nf)
+		return traits_type::eof();
+
+	char number[32];
+	_buffer.clear();
+	auto append = [&](int n) { _buffer.insert(_buffer.end(), number, number + n); };
+	if(_line == 0)
+	{
+		append(std::snprintf(number, sizeof(number), "OFF\n%zu ", nv));
+		append(std::snprintf(number, sizeof(number), "%zu 0\n", nf));
+	}
+	else if(_line <= nv)
+	{
+		auto& v = _mesh.vertices[_line - 1];
+		append(std::snprintf(number, sizeof(number), "%.17g ", v.x));
+		append(std::snprintf(number, sizeof(number), "%.17g ", v.y));
+		append(std::snprintf(number, sizeof(number), "%.17g\n", v.z));
+	}
+	else
+	{
+		auto& f = _mesh.faces[_line - 1 - nv];
+		append(std::snprintf(number, sizeof(number), "%zu", f.size()));
+		for(auto i : f)
+			append(std::snprintf(number, sizeof(number), " %zu", i));
+		_buffer.push_back('\n');
+	}
+	++_line;
+
+	setg(_buffer.data(), _buffer.data(), _buffer.data() + _buffer.size());
+	return traits_type::to_int_type(*gptr());
+}
+
+}
+
+namespace mesh_format
+{
+
+boost::program_options::options_description options()
+{
+	boost::program_options::options_description options("Mesh format");
+	options.add_options()
+		("mesh-format", boost::program_options::value<std::string>(), "Model format [off, stl, ply] where not given by the file extension (default off)")
+	;
+	return options;
+}
+
+mesh::format get(const boost::program_options::variables_map& vm, const std::string& filename)
+{
+	auto fallback = vm.count("mesh-format") ? mesh::parse_format(vm["mesh-format"].as<std::string>()) : mesh::format::off;
+	return mesh::format_of(filename, fallback);
+}
+
+}
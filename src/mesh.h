@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * mesh.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef MESH_H_
+#define MESH_H_
+#include <vector>
+#include <string>
+#include <streambuf>
+#include <cstddef>
+#include <iosfwd>
+#include <boost/program_options.hpp>
+#include "geom/polyhedron.h"
+
+namespace mesh
+{
+
+struct point_3
+{
+	double x;
+	double y;
+	double z;
+};
+
+inline point_3 operator+(const point_3& a, const point_3& b)
+{
+	return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+inline point_3 operator-(const point_3& a, const point_3& b)
+{
+	return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+inline double dot(const point_3& a, const point_3& b)
+{
+	return a.x*b.x + a.y*b.y + a.z*b.z;
+}
+inline point_3 cross(const point_3& a, const point_3& b)
+{
+	return {a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x};
+}
+
+/* Unnormalised face normal by Newell's method; robust for non-convex faces
+ * and collinear vertices. */
+point_3 newell_normal(const std::vector<point_3>& vertices, const std::vector<std::size_t>& face);
+
+/* Ear clipping in the plane the face is most nearly parallel to.
+ * Faces may be non-convex after CSG; a fan is used only if clipping fails.
+ * Always produces size - 2 triangles. */
+void triangulate(const std::vector<point_3>& vertices, const std::vector<std::size_t>& face, std::vector<std::size_t>& triangles);
+
+/*
+ * Plain indexed face set.
+ * Used where the vertices and faces of a polyhedron must be inspected or
+ * generated directly; converted to and from geom::polyhedron_t via OFF.
+ */
+struct mesh_t
+{
+	std::vector<point_3> vertices;
+	std::vector<std::vector<std::size_t>> faces;
+};
+
+bool read_off(std::istream& is, mesh_t& mesh);
+void write_off(std::ostream& os, const mesh_t& mesh);
+
+/* Binary STL holds single precision triangles; coincident corners are
+ * welded into shared vertices when read. Faces are triangulated to write. */
+bool read_stl(std::istream& is, mesh_t& mesh);
+void write_stl(std::ostream& os, const mesh_t& mesh);
+
+/* Binary PLY; read in either byte order, written little endian in double
+ * precision. */
+bool read_ply(std::istream& is, mesh_t& mesh);
+void write_ply(std::ostream& os, const mesh_t& mesh);
+
+enum class format
+{
+	off,
+	stl,
+	ply
+};
+
+format parse_format(const std::string& name);
+/* Format named by the file extension, or fallback if it has none known. */
+format format_of(const std::string& filename, format fallback);
+
+bool read(std::istream& is, mesh_t& mesh, format f);
+void write(std::ostream& os, const mesh_t& mesh, format f);
+
+/* OFF goes directly through geom. Other formats are converted through a
+ * mesh, a line of OFF text at a time. */
+bool read(std::istream& is, geom::polyhedron_t& poly, format f);
+bool read(std::istream& is, geom::object_t& object, format f);
+void write(std::ostream& os, const geom::polyhedron_t& poly, format f);
+
+/* Enclosed volume of a closed, outward facing mesh. */
+double volume(const mesh_t& mesh);
+
+mesh_t to_mesh(const geom::polyhedron_t& poly);
+/* Faces of a polyhedron without building its mesh. */
+std::size_t face_count(const geom::polyhedron_t& poly);
+geom::polyhedron_t to_polyhedron(const mesh_t& mesh);
+
+/*
+ * Builds a mesh from OFF text as it is written, one line at a time, so the
+ * text of a large model is never held in memory.
+ */
+class off_sink : public std::streambuf
+{
+private:
+	enum class state
+	{
+		header,
+		counts,
+		vertices,
+		faces,
+		done
+	};
+
+	mesh_t& _mesh;
+	std::string _line;
+	state _state;
+	std::size_t _vertices;
+	std::size_t _faces;
+	bool _good;
+	bool _counts_only;
+
+	void parse_line();
+protected:
+	virtual int_type overflow(int_type c);
+	virtual std::streamsize xsputn(const char* s, std::streamsize n);
+public:
+	/* With counts_only set only the header is parsed; the vertices and
+	 * faces that follow are discarded without being read. */
+	explicit off_sink(mesh_t& mesh, bool counts_only = false);
+
+	/* True if a complete OFF mesh was written. */
+	bool finish();
+	/* Face count from the header. */
+	std::size_t faces() const { return _faces; }
+};
+
+/*
+ * Produces the OFF text of a mesh as it is read.
+ */
+class off_source : public std::streambuf
+{
+private:
+	const mesh_t& _mesh;
+	std::size_t _line;
+	std::vector<char> _buffer;
+protected:
+	virtual int_type underflow();
+public:
+	explicit off_source(const mesh_t& mesh);
+};
+
+}
+
+/*
+ * --mesh-format for tools reading or writing models.
+ * Files named with a .off, .stl or .ply extension use that format; the
+ * option sets the format of anything else, including stdin and stdout.
+ */
+namespace mesh_format
+{
+
+boost::program_options::options_description options();
+mesh::format get(const boost::program_options::variables_map& vm, const std::string& filename = {});
+
+}
+
+#endif /* MESH_H_ */
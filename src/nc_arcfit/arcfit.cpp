@@ -8,6 +8,7 @@
 #include <vector>
 #include <string>
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 namespace po = boost::program_options;
 
@@ -20,12 +21,11 @@ int main(int argc, char* argv[]) {
      * values passed as parameters should use named units
      * */
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(input_driver::output_options());
+    options.add(rs274_arcfit::options());
     options.add_options()
         ("help,h", "display this help and exit")
-        ("chord_height,c", po::value<double>()->default_value(0.1), "Chord height tolerance")
-        ("radius_dev,r", po::value<double>()->default_value(0.1), "Radius deviation tolerance")
-        ("planar_dev,p", po::value<double>()->default_value(1e-6), "Planar deviation tolerance")
-        ("theta_min,t", po::value<double>()->default_value(3.14/16.0), "Minimum arc theta")
     ;
 
     try {
@@ -38,30 +38,13 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
-        double chord_height_tolerance = vm["chord_height"].as<double>();
-        double point_deviation = vm["radius_dev"].as<double>();
-        double planar_tolerance = vm["planar_dev"].as<double>();
-        double theta_minimum = vm["theta_min"].as<double>();
+        input_driver driver(vm);
 
-        rs274_arcfit arcfit(vm, chord_height_tolerance, point_deviation, planar_tolerance, theta_minimum);
+        rs274_arcfit arcfit(vm);
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = arcfit.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cout << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = arcfit.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(arcfit);
+        if(status != RS274NGC_OK)
+            return status;
 
         if (arcfit.read("M2") == RS274NGC_OK)
             arcfit.execute();
@@ -34,7 +34,7 @@ geometry_3::point_3 rs274_arcfit::to_point_3(const cxxcam::Position& pos) {
     using cxxcam::units::length_inch;
     using namespace machine_config;
 
-    switch (machine_units(config, machine_id)) {
+    switch (machine.length_units) {
         case machine_config::units::metric:
             return {length_mm(pos.X).value(), length_mm(pos.Y).value(), length_mm(pos.Z).value()};
         case machine_config::units::imperial:
@@ -59,7 +59,7 @@ void rs274_arcfit::_linear(const Position& pos) {
     point->l.b = to_point_3(convert(pos));
 }
 
-void rs274_arcfit::block_end(const block_t& block) {
+void rs274_arcfit::_block_end(const block_t& block) {
     // but process it here iff the block describes simple linear motion
     enum {
         G_1 = 10
@@ -88,14 +88,15 @@ void rs274_arcfit::block_end(const block_t& block) {
     
     if (is_linear(block) && point) {
         point->block = block;
+        point->calls = calls();
         push(*point);
     } else {
         flush(true);
-        std::cout << str(block) << "\n";
+        emit(block);
     }
     point = boost::none;
 }
-void rs274_arcfit::program_end() {
+void rs274_arcfit::_program_end() {
     flush(true);
 }
 
@@ -300,8 +301,8 @@ void rs274_arcfit::flush(bool all) {
         case State::indeterminate:
         {
             while (!arc.points.empty()) {
-                auto& block = arc.points[0].block;
-                std::cout << str(block) << "\n";
+                auto& first = arc.points[0];
+                emit(first.block, first.calls);
                 arc.points.erase(begin(arc.points));
 
                 if (!all) break;
@@ -336,7 +337,7 @@ void rs274_arcfit::flush(bool all) {
                     using namespace cxxcam::units;
                     using namespace machine_config;
                     length x;
-                    switch (machine_units(config, machine_id)) {
+                    switch (machine.length_units) {
                         case machine_config::units::metric:
                             x = length{ value * millimeters };
                             break;
@@ -362,7 +363,30 @@ void rs274_arcfit::flush(bool all) {
                 block.j = map_units(arc.center.y - p0.y);
                 block.f = _feed_rate;
 
-                std::cout << str(block) << "\n";
+                // The calls reading the block makes, from the last point
+                std::vector<canon::call> calls;
+                if (recording()) {
+                    calls.resize(3);
+                    calls[0].type = canon::op::feed_rate;
+                    calls[0].value = _feed_rate;
+
+                    auto& a = calls[1];
+                    a.type = canon::op::arc;
+                    a.arc[0] = *block.x;
+                    a.arc[1] = *block.y;
+                    a.arc[2] = map_units(arc.center.x);
+                    a.arc[3] = map_units(arc.center.y);
+                    a.arc[4] = map_units(p0.z);
+                    a.integer = arc.dir == 1 ? -1 : 1;
+                    // Fitted moves are linear only, without rotary motion
+                    a.pos.a = program_pos.a;
+                    a.pos.b = program_pos.b;
+                    a.pos.c = program_pos.c;
+
+                    calls[2].type = canon::op::block_end;
+                    calls[2].block = block;
+                }
+                emit(block, calls);
                 arc.points.clear();
             }
             state = State::indeterminate;
@@ -376,4 +400,19 @@ rs274_arcfit::rs274_arcfit(boost::program_options::variables_map& vm, double cho
  : rs274_base(vm), chord_height_tolerance(chord_height_tolerance), point_deviation(point_deviation), planar_tolerance(planar_tolerance), theta_minimum(theta_minimum) {
      reset();
 }
+rs274_arcfit::rs274_arcfit(boost::program_options::variables_map& vm)
+ : rs274_arcfit(vm, vm["chord_height"].as<double>(), vm["radius_dev"].as<double>(), vm["planar_dev"].as<double>(), vm["theta_min"].as<double>()) {
+}
+
+boost::program_options::options_description rs274_arcfit::options() {
+    namespace po = boost::program_options;
+    po::options_description options("arcfit options");
+    options.add_options()
+        ("chord_height,c", po::value<double>()->default_value(0.1), "Chord height tolerance")
+        ("radius_dev,r", po::value<double>()->default_value(0.1), "Radius deviation tolerance")
+        ("planar_dev,p", po::value<double>()->default_value(1e-6), "Planar deviation tolerance")
+        ("theta_min,t", po::value<double>()->default_value(3.14/16.0), "Minimum arc theta")
+    ;
+    return options;
+}
 
@@ -34,6 +34,8 @@ class rs274_arcfit : public rs274_base
 private:
     struct block_point {
         block_t block;
+        // Canonical calls of the block, if recording()
+        std::vector<canon::call> calls;
         geometry_3::line_3 l;
     };
     boost::optional<block_point> point;
@@ -69,11 +71,14 @@ private:
     virtual void _rapid(const Position& pos);
     virtual void _arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation);
     virtual void _linear(const Position& pos);
-    virtual void block_end(const block_t& block);
-    virtual void program_end();
+    virtual void _block_end(const block_t& block);
+    virtual void _program_end();
 
 public:
 	rs274_arcfit(boost::program_options::variables_map& vm, double chord_height_tolerance, double point_deviation, double planar_tolerance, double theta_minimum);
+	rs274_arcfit(boost::program_options::variables_map& vm);
+
+    static boost::program_options::options_description options();
 
 	virtual ~rs274_arcfit() = default;
 };
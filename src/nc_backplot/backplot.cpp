@@ -9,6 +9,7 @@
 #include "geom/polyhedron.h"
 #include "geom/io.h"
 #include "throw_if.h"
+#include "mesh.h"
 
 #include "rs274_backplot.h"
 #include "rs274ngc_return.hh"
@@ -16,6 +17,7 @@
 #include <boost/program_options.hpp>
 #include "print_exception.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <fstream>
@@ -255,6 +257,8 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(mesh_format::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("model", po::value<std::string>(), "Model file")
@@ -296,13 +300,15 @@ int main(int argc, char* argv[]) {
         std::thread model_thread([&]{
             if(vm.count("model")) {
                 geom::object_t model;
-                std::ifstream is(vm["model"].as<std::string>());
-                throw_if(!(is >> model), "Unable to read model from file");
+                auto filename = vm["model"].as<std::string>();
+                std::ifstream is(filename, std::ios::binary);
+                throw_if(!mesh::read(is, model, mesh_format::get(vm, filename)), "Unable to read model from file");
 
                 pushModel(root, model);
             }
         });
 
+        input_driver driver(vm);
         rs274_backplot backplotter{vm, root};
 
         auto adapt = [gw](const sf::Event& event) {
@@ -357,25 +363,10 @@ int main(int argc, char* argv[]) {
 
         std::thread rs274_thread([&] {
 
-            std::string line;
-            while(running && std::getline(std::cin, line)) {
-                int status;
-                
-                status = backplotter.read(line.c_str());
-                if(status != RS274NGC_OK) {
-                    if(status != RS274NGC_EXECUTE_FINISH) {
-                        std::cerr << "Error reading line!: \n";
-                        std::cerr << line <<"\n";
-                        return status;
-                    }
-                }
-                
-                status = backplotter.execute();
-                if(status != RS274NGC_OK)
-                    return status;
+            return driver.run(backplotter, [&](const char* line) {
                 std::cerr << line << "\n";
-            }
-            return 0;
+                return running.load();
+            });
         });
 
         while(running) {
@@ -27,18 +27,19 @@
 #include <cstring>
 #include <osg/Geometry>
 #include "base/machine_config.h"
+#include "base/motion_steps.h"
 
-void rs274_backplot::pushBackplot(osg::Geode* geode, const std::vector<cxxcam::path::step>& steps, bool cut) {
+template <typename Steps>
+void rs274_backplot::pushBackplot(osg::Geode* geode, const Steps& steps, bool cut) {
     auto geom = new osg::Geometry();
-    auto units = machine_config::machine_units(config, machine_id);
+    auto units = machine.length_units;
 
     auto vertices = new osg::Vec3Array;
     vertices->reserve(steps.size());
-    for(auto& step : steps)
+    for(auto p : steps)
     {
         using cxxcam::units::length_mm;
         using cxxcam::units::length_inch;
-        auto& p = step.position;
 
         switch (units) {
             case machine_config::units::metric:
@@ -71,21 +72,18 @@ void rs274_backplot::pushBackplot(osg::Geode* geode, const std::vector<cxxcam::p
 
 void rs274_backplot::_rapid(const Position& pos)
 {
-	auto steps = cxxcam::path::expand_linear(convert(program_pos), convert(pos), {}, -1).path;
-    pushBackplot(geode, steps, false);
+    pushBackplot(geode, motion::linear_steps(convert(program_pos), convert(pos)), false);
 }
 
 void rs274_backplot::_arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation)
 {
     using namespace cxxcam::path;
-	auto steps = expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation), {}).path;
-    pushBackplot(geode, steps, true);
+    pushBackplot(geode, motion::arc_steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation)), true);
 }
 
 void rs274_backplot::_linear(const Position& pos)
 {
-	auto steps = cxxcam::path::expand_linear(convert(program_pos), convert(pos), {}, -1).path;
-    pushBackplot(geode, steps, true);
+    pushBackplot(geode, motion::linear_steps(convert(program_pos), convert(pos)), true);
 }
 
 rs274_backplot::rs274_backplot(boost::program_options::variables_map& vm, osg::Group* parent)
@@ -33,7 +33,8 @@ class rs274_backplot : public rs274_base
 {
 private:
     osg::Geode* geode;
-    void pushBackplot(osg::Geode* geode, const std::vector<cxxcam::path::step>& steps, bool cut);
+    template <typename Steps>
+    void pushBackplot(osg::Geode* geode, const Steps& steps, bool cut);
 
     virtual void _rapid(const Position& pos);
     virtual void _arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation);
@@ -0,0 +1,272 @@
+#include "corpus.h"
+#include <boost/program_options.hpp>
+#include "print_exception.h"
+#include "../throw_if.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+namespace po = boost::program_options;
+
+namespace {
+
+struct input {
+    std::string name;
+    std::function<std::size_t(std::ostream&, std::size_t)> generate;
+    // Lines relative to --lines
+    double scale;
+    std::string path;
+    std::size_t lines;
+};
+
+struct tool {
+    std::string name;
+    std::string exe;
+    std::vector<std::string> args;
+    std::vector<std::string> inputs;
+};
+
+struct result {
+    double wall_s;
+    long peak_rss_kb;
+    int exit;
+    // --stats counters named with a merge level
+    std::vector<std::pair<std::string, std::uint64_t>> counters;
+};
+
+/* The --stats summary ends with one "name value" line per counter. */
+std::vector<std::pair<std::string, std::uint64_t>> merge_counters(std::istream& is) {
+    std::vector<std::pair<std::string, std::uint64_t>> counters;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.compare(0, 12, "merge level ") != 0)
+            continue;
+        auto end = line.find_last_not_of(" ");
+        auto space = line.find_last_of(" ", end);
+        if (end == std::string::npos || space == std::string::npos)
+            continue;
+        auto name = line.substr(0, line.find_last_not_of(" ", space) + 1);
+        counters.emplace_back(name, std::strtoull(line.c_str() + space + 1, nullptr, 10));
+    }
+    return counters;
+}
+
+/* Run the tool with the input file as stdin and stdout discarded.
+ * Tools run with --stats have their error output kept for the counters. */
+result run(const std::string& exe, const std::vector<std::string>& args, const std::string& input, bool verbose) {
+    bool stats = std::find(begin(args), end(args), "--stats") != end(args);
+    auto log = input + ".stats";
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(exe.c_str()));
+    for (auto& a : args)
+        argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    auto pid = ::fork();
+    throw_if(pid < 0, "Unable to fork");
+    if (pid == 0) {
+        auto in = ::open(input.c_str(), O_RDONLY);
+        auto null = ::open("/dev/null", O_WRONLY);
+        auto err = stats ? ::open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) : null;
+        if (in < 0 || null < 0 || err < 0)
+            ::_exit(127);
+        ::dup2(in, STDIN_FILENO);
+        ::dup2(null, STDOUT_FILENO);
+        if (stats || !verbose)
+            ::dup2(err, STDERR_FILENO);
+        ::execv(exe.c_str(), argv.data());
+        ::_exit(127);
+    }
+
+    // rusage of the child alone, rather than all children so far
+    int status;
+    struct rusage usage;
+    pid_t w;
+    do {
+        w = ::wait4(pid, &status, 0, &usage);
+    } while (w < 0 && errno == EINTR);
+    throw_if(w < 0, "Unable to wait for " + exe);
+    auto end = std::chrono::steady_clock::now();
+
+    result r;
+    r.wall_s = std::chrono::duration<double>(end - start).count();
+    r.peak_rss_kb = usage.ru_maxrss;
+    r.exit = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    if (stats) {
+        std::ifstream is(log);
+        std::stringstream text;
+        text << is.rdbuf();
+        if (verbose)
+            std::cerr << text.str();
+        r.counters = merge_counters(text);
+        ::unlink(log.c_str());
+    }
+    return r;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    po::options_description options("nc_bench");
+    std::vector<std::string> args(argv, argv + argc);
+    args.erase(begin(args));
+
+    options.add_options()
+        ("help,h", "display this help and exit")
+        ("tools-dir", po::value<std::string>()->default_value(NC_TOOLS_BINARY_DIR), "Directory containing the nc_* tools")
+        ("corpus-dir", po::value<std::string>()->default_value("."), "Directory to write the generated inputs to")
+        ("lines,n", po::value<std::size_t>()->default_value(1000000), "Lines in the largest generated input")
+        ("repeat,r", po::value<unsigned>()->default_value(3), "Runs of each benchmark; the fastest is reported")
+        ("only", po::value<std::vector<std::string>>()->multitoken(), "Only run these tools")
+        ("config", po::value<std::string>(), "Configuration file passed to the tools")
+        ("machine", po::value<std::string>(), "Mill machine configuration passed to the tools")
+        ("lathe-machine", po::value<std::string>(), "Lathe machine configuration for nc_lathe_roughing")
+        ("verbose,v", "Show the tool error output")
+    ;
+
+    try {
+        po::variables_map vm;
+        store(po::command_line_parser(args).options(options).run(), vm);
+
+        if(vm.count("help")) {
+            std::cout << options << "\n";
+            std::cout << "Writes one JSON object per benchmark to stdout\n";
+            return 0;
+        }
+        notify(vm);
+
+        auto tools_dir = vm["tools-dir"].as<std::string>();
+        auto corpus_dir = vm["corpus-dir"].as<std::string>();
+        auto lines = vm["lines"].as<std::size_t>();
+        auto repeat = std::max(1u, vm["repeat"].as<unsigned>());
+        bool verbose = vm.count("verbose");
+
+        std::vector<input> inputs = {
+            {"raster", corpus::raster, 1.0, {}, 0},
+            {"arcs", corpus::arcs, 0.5, {}, 0},
+            {"svg", corpus::svg, 0.05, {}, 0},
+            {"lathe", corpus::lathe, 0.01, {}, 0},
+            {"pocket", corpus::pocket, 0.002, {}, 0},
+            {"model", corpus::model, 0.002, {}, 0},
+        };
+
+        std::vector<std::string> machine;
+        if (vm.count("config"))
+            machine.insert(machine.end(), {"--config", vm["config"].as<std::string>()});
+        auto lathe_machine = machine;
+        if (vm.count("machine"))
+            machine.insert(machine.end(), {"--machine", vm["machine"].as<std::string>()});
+        if (vm.count("lathe-machine"))
+            lathe_machine.insert(lathe_machine.end(), {"--machine", vm["lathe-machine"].as<std::string>()});
+
+        auto stock = corpus_dir + "/stock.off";
+        auto with = [](std::vector<std::string> a, std::vector<std::string> b) {
+            a.insert(a.end(), begin(b), end(b));
+            return a;
+        };
+        std::vector<std::string> gcode = {"raster", "arcs", "lathe"};
+        std::vector<tool> tools = {
+            {"nc_identity", "nc_identity", machine, gcode},
+            {"nc_arcfit", "nc_arcfit", machine, gcode},
+            {"nc_bounds", "nc_bounds", with(machine, {"--cut"}), gcode},
+            {"nc_shortlines", "nc_shortlines", machine, {"arcs", "lathe"}},
+            {"nc_contour_pocket", "nc_contour_pocket", with(machine, {"-r", "1", "-z", "-2", "-f", "500", "-d", "1"}), {"pocket"}},
+            {"nc_spiral_pocket", "nc_spiral_pocket", with(machine, {"-r", "1", "-z", "-2", "-f", "500", "-d", "1"}), {"pocket"}},
+            {"nc_model", "nc_model", with(machine, {"--stock", stock, "--stats"}), {"model"}},
+            {"nc_model_index_merge", "nc_model", with(machine, {"--stock", stock, "--stats", "--merge-order", "index"}), {"model"}},
+            {"nc_model_dexel", "nc_model", with(machine, {"--stock", stock, "--engine", "dexel"}), {"model"}},
+            {"nc_svgpath", "nc_svgpath", {"-f", "500"}, {"svg"}},
+            {"nc_lathe_roughing", "nc_lathe_roughing", with(lathe_machine, {"-D", "0.5"}), {"lathe"}},
+        };
+
+        if (vm.count("only")) {
+            auto only = vm["only"].as<std::vector<std::string>>();
+            tools.erase(std::remove_if(begin(tools), end(tools), [&](const tool& t) {
+                return std::find(begin(only), end(only), t.name) == end(only);
+            }), end(tools));
+        }
+
+        // Generate only the inputs the selected tools use
+        for (auto& in : inputs) {
+            bool used = std::any_of(begin(tools), end(tools), [&](const tool& t) {
+                return std::find(begin(t.inputs), end(t.inputs), in.name) != end(t.inputs);
+            });
+            if (!used) continue;
+
+            in.path = corpus_dir + "/" + in.name + (in.name == "svg" ? ".svg" : ".ngc");
+            std::ofstream os(in.path);
+            throw_if(!os, "Unable to write " + in.path);
+            in.lines = in.generate(os, std::max<std::size_t>(10, lines * in.scale));
+            if (in.name == "model") {
+                std::ofstream off(stock);
+                corpus::stock(off);
+            }
+        }
+
+        int failures = 0;
+        for (auto& t : tools) {
+            auto exe = tools_dir + "/" + t.exe;
+            for (auto& name : t.inputs) {
+                auto& in = *std::find_if(begin(inputs), end(inputs), [&](const input& i) { return i.name == name; });
+
+                result best = {0, 0, 0, {}};
+                for (unsigned i = 0; i < repeat; ++i) {
+                    auto r = run(exe, t.args, in.path, verbose);
+                    if (i == 0 || r.wall_s < best.wall_s) {
+                        best.wall_s = r.wall_s;
+                        best.counters = r.counters;
+                    }
+                    best.peak_rss_kb = std::max(best.peak_rss_kb, r.peak_rss_kb);
+                    best.exit = std::max(best.exit, r.exit);
+                }
+                if (best.exit) ++failures;
+
+                std::cout << "{\"tool\": \"" << t.name << "\""
+                          << ", \"input\": \"" << in.name << "\""
+                          << ", \"lines\": " << in.lines
+                          << ", \"runs\": " << repeat
+                          << ", \"wall_s\": " << best.wall_s
+                          << ", \"lines_per_s\": " << (best.wall_s > 0 ? in.lines / best.wall_s : 0)
+                          << ", \"peak_rss_kb\": " << best.peak_rss_kb
+                          << ", \"exit\": " << best.exit;
+                if (!best.counters.empty()) {
+                    std::cout << ", \"counters\": {";
+                    for (std::size_t i = 0; i < best.counters.size(); ++i)
+                        std::cout << (i ? ", " : "") << "\"" << best.counters[i].first << "\": " << best.counters[i].second;
+                    std::cout << "}";
+                }
+                std::cout << "}" << std::endl;
+            }
+        }
+        if (failures)
+            return 1;
+
+    } catch(const po::error& e) {
+        print_exception(e);
+        std::cout << options << "\n";
+        return 1;
+    } catch(const std::exception& e) {
+        print_exception(e);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * corpus.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "corpus.h"
+#include "r6.h"
+#include <cmath>
+#include <ostream>
+
+namespace corpus {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+double surface(double x, double y) {
+    return -2.0 + std::sin(x * 0.1) * std::cos(y * 0.07) + 0.5 * std::sin(x * 0.013 + y * 0.021);
+}
+
+std::size_t mill_header(std::ostream& os) {
+    os << "G21 G90 G17\n";
+    os << "T1 M6\n";
+    os << "S10000 M3\n";
+    os << "F1000\n";
+    os << "G0 Z5\n";
+    return 5;
+}
+
+std::size_t footer(std::ostream& os) {
+    os << "G0 Z5\n";
+    os << "M2\n";
+    return 2;
+}
+
+}
+
+std::size_t raster(std::ostream& os, std::size_t lines) {
+    const double step = 0.1;
+    const std::size_t row = 1000;
+    const double stepover = 0.5;
+
+    auto n = mill_header(os);
+    os << "G0 X0 Y0\n";
+    os << "G1 Z" << r6(surface(0, 0)) << "\n";
+    n += 2;
+    for (std::size_t i = 0; n + 2 < lines; ++i) {
+        auto r = i / row;
+        auto c = i % row;
+        auto x = ((r % 2) ? row - 1 - c : c) * step;
+        auto y = r * stepover;
+        os << "G1 X" << r6(x) << " Y" << r6(y) << " Z" << r6(surface(x, y)) << "\n";
+        ++n;
+    }
+    return n + footer(os);
+}
+
+std::size_t arcs(std::ostream& os, std::size_t lines) {
+    const double pitch = 6.0;
+    const std::size_t per_row = 40;
+    const double depth = -0.2;
+
+    auto n = mill_header(os);
+    for (std::size_t g = 0; n + 2 < lines; ++g) {
+        /* Glyph of tangent quarter arcs of one radius, alternating direction
+         * so each arc starts where the last ended with the center reflected. */
+        auto arcs = 4 + g % 9;
+        auto r = 0.5 + (g % 5) * 0.2;
+        auto cx = (g % per_row) * pitch;
+        auto cy = (g / per_row) * pitch;
+        double px = cx + r;
+        double py = cy;
+        double theta = 0;
+        bool ccw = true;
+        os << "G0 X" << r6(px) << " Y" << r6(py) << "\n";
+        os << "G1 Z" << r6(depth) << "\n";
+        n += 2;
+        for (std::size_t a = 0; a < arcs && n + 3 < lines; ++a) {
+            auto t1 = theta + (ccw ? PI : -PI) / 2;
+            auto x1 = cx + r * std::cos(t1);
+            auto y1 = cy + r * std::sin(t1);
+            os << (ccw ? "G3" : "G2") << " X" << r6(x1) << " Y" << r6(y1) << " I" << r6(cx - px) << " J" << r6(cy - py) << "\n";
+            ++n;
+            cx = 2 * x1 - cx;
+            cy = 2 * y1 - cy;
+            theta = t1 + PI;
+            px = x1;
+            py = y1;
+            ccw = !ccw;
+        }
+        os << "G0 Z1\n";
+        ++n;
+    }
+    return n + footer(os);
+}
+
+std::size_t svg(std::ostream& os, std::size_t lines) {
+    std::size_t n = 0;
+    for (; n < lines; ++n) {
+        auto ox = (n % 100) * 10.0;
+        auto oy = (n / 100) * 10.0;
+        os << "M" << r6(ox) << "," << r6(oy);
+        for (unsigned k = 0; k < 8; ++k) {
+            auto t = (n * 8 + k) * 0.37;
+            auto x = ox + 1 + k;
+            auto y = oy + 5 + 3 * std::sin(t);
+            if (k % 2)
+                os << " Q" << r6(x - 0.5) << "," << r6(y + 2) << " " << r6(x) << "," << r6(y);
+            else
+                os << " C" << r6(x - 0.7) << "," << r6(y - 2) << " " << r6(x - 0.3) << "," << r6(y + 2) << " " << r6(x) << "," << r6(y);
+        }
+        os << " Z\n";
+    }
+    return n;
+}
+
+std::size_t lathe(std::ostream& os, std::size_t lines) {
+    std::size_t n = 0;
+    os << "G18 G21 G90\n";
+    os << "G0 X20 Z1\n";
+    n += 2;
+    // Profile from the face back along Z, radius varying along the part
+    auto segments = lines > n + 2 ? lines - n - 2 : 1;
+    auto length = 100.0;
+    for (std::size_t i = 0; i <= segments && n + 1 < lines; ++i) {
+        auto z = -length * i / segments;
+        auto x = 10 + 4 * std::sin(z * 0.2) + 2 * std::cos(z * 0.05);
+        os << "G1 X" << r6(x) << " Z" << r6(z) << "\n";
+        ++n;
+    }
+    os << "M2\n";
+    return n + 1;
+}
+
+std::size_t pocket(std::ostream& os, std::size_t lines) {
+    auto n = mill_header(os);
+    auto points = lines > n + 4 ? lines - n - 4 : 3;
+    auto at = [&](std::size_t i, double& x, double& y) {
+        auto t = 2 * PI * i / points;
+        auto r = 40 + 4 * std::sin(t * 7) + std::cos(t * 31);
+        x = 50 + r * std::cos(t);
+        y = 50 + r * std::sin(t);
+    };
+    double x, y;
+    at(0, x, y);
+    os << "G0 X" << r6(x) << " Y" << r6(y) << "\n";
+    os << "G1 Z0\n";
+    n += 2;
+    for (std::size_t i = 1; i <= points; ++i) {
+        at(i % points, x, y);
+        os << "G1 X" << r6(x) << " Y" << r6(y) << "\n";
+        ++n;
+    }
+    return n + footer(os);
+}
+
+std::size_t model(std::ostream& os, std::size_t lines) {
+    const double step = 0.5;
+    const std::size_t row = 40;
+
+    auto n = mill_header(os);
+    os << "G0 X0 Y0\n";
+    os << "G1 Z-1\n";
+    n += 2;
+    for (std::size_t i = 0; n + 2 < lines; ++i) {
+        auto r = (i / row) % row;
+        auto c = i % row;
+        auto x = ((r % 2) ? row - 1 - c : c) * step;
+        auto y = r * step;
+        auto z = -1 - 0.5 * std::sin(x * 0.3) * std::cos(y * 0.3) - (i / (row * row)) * 0.5;
+        os << "G1 X" << r6(x) << " Y" << r6(y) << " Z" << r6(z) << "\n";
+        ++n;
+    }
+    return n + footer(os);
+}
+
+void stock(std::ostream& os) {
+    // 20 x 20 x 10 box with the top face at Z0
+    os << "OFF\n8 6 0\n";
+    os << "0 0 -10\n20 0 -10\n20 20 -10\n0 20 -10\n";
+    os << "0 0 0\n20 0 0\n20 20 0\n0 20 0\n";
+    os << "4 0 3 2 1\n4 4 5 6 7\n4 0 1 5 4\n4 1 2 6 5\n4 2 3 7 6\n4 3 0 4 7\n";
+}
+
+}
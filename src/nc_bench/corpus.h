@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * corpus.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef CORPUS_H_
+#define CORPUS_H_
+#include <cstddef>
+#include <iosfwd>
+
+/*
+ * Synthetic inputs for nc_bench, deterministic for a given size.
+ * Each generator writes roughly the requested number of lines and returns
+ * the number actually written.
+ */
+namespace corpus {
+
+/* 3D raster finishing pass over a wavy surface, one G1 per line. */
+std::size_t raster(std::ostream& os, std::size_t lines);
+
+/* Engraving of many small glyphs built from G2/G3 arcs. */
+std::size_t arcs(std::ostream& os, std::size_t lines);
+
+/* SVG path data, one subpath of cubic and quadratic curves per line. */
+std::size_t svg(std::ostream& os, std::size_t lines);
+
+/* G18 turned profile for lathe roughing. */
+std::size_t lathe(std::ostream& os, std::size_t lines);
+
+/* Single closed wavy boundary for pocketing. */
+std::size_t pocket(std::ostream& os, std::size_t lines);
+
+/* Shallow raster over the box written by stock(). */
+std::size_t model(std::ostream& os, std::size_t lines);
+
+/* Small box stock in OFF format. */
+void stock(std::ostream& os);
+
+}
+
+#endif /* CORPUS_H_ */
@@ -2,11 +2,11 @@
 #include "rs274ngc_return.hh"
 #include <boost/program_options.hpp>
 #include "print_exception.h"
-#include "geom/polyhedron.h"
-#include "geom/query.h"
+#include "off_bounds.h"
 #include "../throw_if.h"
 #include "../r6.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -26,11 +26,11 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(rs274_bounds::options());
+    options.add(mesh_format::options());
     options.add_options()
         ("help,h", "display this help and exit")
-        ("cut,c", "track cuts in gcode")
-        ("rapid,r", "track rapids in gcode")
-        ("model,m", "calculate bounding box of model")
     ;
 
     try {
@@ -43,12 +43,14 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
-        if (vm.count("model")) {
-            geom::polyhedron_t model;
-            throw_if(!(std::cin >> geom::format::off >> model), "Unable to read model from file");
+        input_driver driver(vm);
 
-            auto bounding_box = geom::bounding_box(model);
-            std::cout << bounding_box << "\n";
+        if (vm.count("model")) {
+            auto format = mesh_format::get(vm, vm["input"].as<std::string>());
+            if (format == mesh::format::off)
+                std::cout << off_bounds(driver.input()) << "\n";
+            else
+                std::cout << mesh_bounds(driver.input(), format) << "\n";
 
         } else {
             bool cut = vm.count("cut");
@@ -57,23 +59,9 @@ int main(int argc, char* argv[]) {
                 cut = true;
             rs274_bounds bounding_box(vm, cut, rapid);
 
-            std::string line;
-            while(std::getline(std::cin, line)) {
-                int status;
-
-                status = bounding_box.read(line.c_str());
-                if(status != RS274NGC_OK) {
-                    if(status != RS274NGC_EXECUTE_FINISH) {
-                        std::cerr << "Error reading line!: \n";
-                        std::cout << line <<"\n";
-                        return status;
-                    }
-                }
-                
-                status = bounding_box.execute();
-                if(status != RS274NGC_OK)
-                    return status;
-            }
+            auto status = driver.run(bounding_box);
+            if(status != RS274NGC_OK)
+                return status;
 
             std::cout << bounding_box.bounding_box() << "\n";
         }
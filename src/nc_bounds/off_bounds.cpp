@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * off_bounds.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "off_bounds.h"
+#include "base/input_driver.h"
+#include "thread_pool.h"
+#include "throw_if.h"
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <sstream>
+#include <future>
+#include <istream>
+#include <streambuf>
+
+namespace {
+
+// Vertex bytes examined per round; limits memory held from a pipe
+const std::size_t window_size = 64 << 20;
+// Parts below this are not worth a task
+const std::size_t min_part = 1 << 20;
+
+bool space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Decimal to double. Exact when the significand fits in 53 bits and the
+ * power of ten is exact (the common case for mesh files); everything else
+ * goes through strtod. */
+const char* parse_double(const char* p, const char* end, double& value) {
+    while (p != end && space(*p)) ++p;
+    auto first = p;
+
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    std::uint64_t m = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p, any = true) {
+        if (digits < 19) {
+            m = m * 10 + (*p - '0');
+            if (m) ++digits;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p != end && *p == '.') {
+        for (++p; p != end && *p >= '0' && *p <= '9'; ++p, any = true) {
+            if (digits < 19) {
+                m = m * 10 + (*p - '0');
+                if (m) ++digits;
+                --exponent;
+            }
+        }
+    }
+    bool simple = any;
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        auto q = p + 1;
+        bool eneg = false;
+        if (q != end && (*q == '-' || *q == '+'))
+            eneg = *q++ == '-';
+        int e = 0;
+        bool edigits = false;
+        for (; q != end && *q >= '0' && *q <= '9'; ++q, edigits = true)
+            e = std::min(e * 10 + (*q - '0'), 100000);
+        if (edigits) {
+            exponent += eneg ? -e : e;
+            p = q;
+        }
+    }
+
+    if (simple && digits < 19 && m < (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        double v = static_cast<double>(m);
+        v = exponent < 0 ? v / pow10[-exponent] : v * pow10[exponent];
+        value = negative ? -v : v;
+        return p;
+    }
+
+    // Slow path: copy the token so strtod cannot run past the window
+    auto last = first;
+    while (last != end && !space(*last) && *last != '\n') ++last;
+    throw_if(last == first || last - first > 255, "Invalid vertex coordinate in OFF model");
+    char token[256];
+    std::memcpy(token, first, last - first);
+    token[last - first] = 0;
+    char* stop;
+    value = std::strtod(token, &stop);
+    throw_if(stop == token, "Invalid vertex coordinate in OFF model");
+    return first + (stop - token);
+}
+
+// First non blank character of the line at p, or the line end
+const char* content(const char* p, const char* end) {
+    while (p != end && space(*p)) ++p;
+    return p;
+}
+bool data_line(const char* p, const char* end) {
+    p = content(p, end);
+    return p != end && *p != '\n' && *p != '#';
+}
+const char* next_line(const char* p, const char* end) {
+    auto nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+struct part_result {
+    double min[3];
+    double max[3];
+    const char* stop;
+};
+
+/* Parses up to limit vertex lines of [p, end). Coordinates are staged in a
+ * small batch so that the min / max reduction runs as a plain loop the
+ * compiler vectorises. */
+part_result parse_part(const char* p, const char* end, std::size_t limit) {
+    const std::size_t batch = 256;
+    double c[3][batch];
+    std::size_t n = 0;
+
+    part_result r;
+    for (unsigned k = 0; k < 3; ++k) {
+        r.min[k] = std::numeric_limits<double>::infinity();
+        r.max[k] = -std::numeric_limits<double>::infinity();
+    }
+    auto reduce = [&] {
+        for (unsigned k = 0; k < 3; ++k) {
+            auto lo = r.min[k];
+            auto hi = r.max[k];
+            for (std::size_t i = 0; i < n; ++i) {
+                lo = c[k][i] < lo ? c[k][i] : lo;
+                hi = c[k][i] > hi ? c[k][i] : hi;
+            }
+            r.min[k] = lo;
+            r.max[k] = hi;
+        }
+        n = 0;
+    };
+
+    while (limit && p != end) {
+        auto line_end = next_line(p, end);
+        if (data_line(p, line_end)) {
+            auto q = p;
+            for (unsigned k = 0; k < 3; ++k)
+                q = parse_double(q, line_end, c[k][n]);
+            if (++n == batch)
+                reduce();
+            --limit;
+        }
+        p = line_end;
+    }
+    reduce();
+    r.stop = p;
+    return r;
+}
+
+std::size_t count_lines(const char* p, const char* end) {
+    std::size_t n = 0;
+    while (p != end) {
+        auto line_end = next_line(p, end);
+        if (data_line(p, line_end))
+            ++n;
+        p = line_end;
+    }
+    return n;
+}
+
+// Binary input straight from the reader's blocks
+class reader_buffer : public std::streambuf
+{
+private:
+    line_reader& _input;
+protected:
+    virtual int_type underflow() {
+        _input.skip(gptr() - eback());
+        const char* data;
+        auto available = _input.peek(1 << 20, data);
+        auto p = const_cast<char*>(data);
+        setg(p, p, p + available);
+        return available ? traits_type::to_int_type(*p) : traits_type::eof();
+    }
+public:
+    explicit reader_buffer(line_reader& input)
+     : _input(input) {
+    }
+    ~reader_buffer() {
+        // Consume only what was read
+        _input.skip(gptr() - eback());
+    }
+};
+
+// Reads the header up to and including the counts line; returns the vertex count
+std::size_t read_header(line_reader& input) {
+    const char* line;
+    std::size_t length;
+    auto next = [&] {
+        while (input.next(line, length)) {
+            auto p = content(line, line + length);
+            if (p != line + length && *p != '#')
+                return true;
+        }
+        return false;
+    };
+
+    throw_if(!next(), "Empty OFF model");
+    std::istringstream header(std::string(line, length));
+    std::string magic;
+    header >> magic;
+    throw_if(magic.size() < 3 || magic.compare(magic.size() - 3, 3, "OFF") != 0, "Not an OFF model");
+
+    long vertices;
+    if (!(header >> vertices)) {
+        throw_if(!next(), "Missing OFF counts");
+        std::istringstream counts(std::string(line, length));
+        throw_if(!(counts >> vertices), "Invalid OFF counts");
+    }
+    throw_if(vertices < 0, "Invalid OFF counts");
+    return vertices;
+}
+
+}
+
+geom::query::bbox_3 off_bounds(line_reader& input) {
+    auto remaining = read_header(input);
+    throw_if(remaining == 0, "OFF model has no vertices");
+
+    auto& pool = thread_pool::instance();
+    double min[3];
+    double max[3];
+    for (unsigned k = 0; k < 3; ++k) {
+        min[k] = std::numeric_limits<double>::infinity();
+        max[k] = -std::numeric_limits<double>::infinity();
+    }
+
+    auto window = window_size;
+    while (remaining) {
+        const char* data;
+        auto available = input.peek(window, data);
+        throw_if(available == 0, "Truncated OFF model");
+
+        // Whole lines only, unless this is the end of the input
+        auto end = data + available;
+        if (available == window) {
+            auto p = end;
+            while (p != data && p[-1] != '\n') --p;
+            if (p == data) {
+                window *= 2;
+                continue;
+            }
+            end = p;
+        }
+
+        // Split on line boundaries
+        std::vector<const char*> bounds = {data};
+        auto parts = std::max<std::size_t>(1, std::min<std::size_t>(pool.size() * 4, (end - data) / min_part));
+        for (std::size_t i = 1; i < parts; ++i) {
+            auto p = std::max(bounds.back(), data + (end - data) * i / parts);
+            bounds.push_back(p == end ? end : next_line(p, end));
+        }
+        bounds.push_back(end);
+
+        std::vector<std::future<std::size_t>> counts;
+        for (std::size_t i = 0; i + 1 < bounds.size(); ++i) {
+            auto p0 = bounds[i];
+            auto p1 = bounds[i + 1];
+            counts.push_back(pool.submit([p0, p1] { return count_lines(p0, p1); }));
+        }
+
+        // Only the vertex lines still outstanding are parsed
+        std::vector<std::future<part_result>> results;
+        std::size_t assigned = 0;
+        for (std::size_t i = 0; i < counts.size() && assigned < remaining; ++i) {
+            auto limit = std::min(pool.get(counts[i]), remaining - assigned);
+            assigned += limit;
+            auto p0 = bounds[i];
+            auto p1 = bounds[i + 1];
+            results.push_back(pool.submit([p0, p1, limit] { return parse_part(p0, p1, limit); }));
+        }
+
+        const char* stop = data;
+        for (auto& f : results) {
+            auto r = pool.get(f);
+            for (unsigned k = 0; k < 3; ++k) {
+                min[k] = std::min(min[k], r.min[k]);
+                max[k] = std::max(max[k], r.max[k]);
+            }
+            stop = r.stop;
+        }
+        // Remaining count futures refer to this window; finish before moving on
+        for (auto& f : counts)
+            if (f.valid()) pool.get(f);
+
+        if (assigned == 0) {
+            // Nothing but comments in this window
+            throw_if(available < window, "Truncated OFF model");
+            stop = end;
+        }
+        remaining -= assigned;
+        input.skip(stop - data);
+    }
+
+    // Faces are not needed; drain so that a writer on a pipe is not cut off
+    const char* data;
+    while (auto available = input.peek(window_size, data))
+        input.skip(available);
+
+    geom::query::bbox_3 box;
+    box.min.x = min[0]; box.min.y = min[1]; box.min.z = min[2];
+    box.max.x = max[0]; box.max.y = max[1]; box.max.z = max[2];
+    return box;
+}
+
+geom::query::bbox_3 mesh_bounds(line_reader& input, mesh::format format) {
+    mesh::mesh_t model;
+    {
+        reader_buffer buffer(input);
+        std::istream is(&buffer);
+        throw_if(!mesh::read(is, model, format), "Unable to read model");
+    }
+    throw_if(model.vertices.empty(), "Model has no vertices");
+
+    auto& v = model.vertices.front();
+    geom::query::bbox_3 box = {{v.x, v.y, v.z}, {v.x, v.y, v.z}};
+    for (auto& p : model.vertices) {
+        box.min = {std::min(box.min.x, p.x), std::min(box.min.y, p.y), std::min(box.min.z, p.z)};
+        box.max = {std::max(box.max.x, p.x), std::max(box.max.y, p.y), std::max(box.max.z, p.z)};
+    }
+    return box;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * off_bounds.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef OFF_BOUNDS_H_
+#define OFF_BOUNDS_H_
+#include "geom/query.h"
+#include "mesh.h"
+
+class line_reader;
+
+/*
+ * Bounding box of an OFF model read straight from the input.
+ * Only the vertex block is parsed, in chunks split across the thread pool;
+ * no polyhedron is built. The rest of the input is drained unparsed.
+ */
+geom::query::bbox_3 off_bounds(line_reader& input);
+
+/* Bounding box of a binary STL or PLY model read from the input. */
+geom::query::bbox_3 mesh_bounds(line_reader& input, mesh::format format);
+
+#endif /* OFF_BOUNDS_H_ */
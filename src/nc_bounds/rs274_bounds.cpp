@@ -29,6 +29,7 @@
 #include "fold_adjacent.h"
 #include <algorithm>
 #include "cxxcam/Path.h"
+#include "base/motion_steps.h"
 
 cxxcam::math::point_3 pos2point(const cxxcam::Position& pos) {
     return {pos.X, pos.Y, pos.Z};
@@ -49,31 +50,28 @@ void rs274_bounds::_rapid(const Position& pos) {
 void rs274_bounds::_arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation) {
     using namespace cxxcam::path;
     if (track_cut) {
-        auto steps = expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation), {}).path;
-
-        for (auto& step : steps) {
-            if (!first_point) {
-                bbox.min = bbox.max = step.position;
-                first_point = true;
-            }
-            bbox += step.position;
+        cxxcam::math::point_3 min;
+        cxxcam::math::point_3 max;
+        motion::arc_steps arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation));
+        arc.bounds(min, max);
+        if (!first_point) {
+            bbox.min = bbox.max = min;
+            first_point = true;
         }
+        bbox += min;
+        bbox += max;
     }
 }
 
 
 void rs274_bounds::_linear(const Position& pos) {
-    using namespace cxxcam::path;
     if (track_cut) {
-        auto steps = expand_linear(convert(program_pos), convert(pos), {}, -1).path;
-
-        for (auto& step : steps) {
-            if (!first_point) {
-                bbox.min = bbox.max = step.position;
-                first_point = true;
-            }
-            bbox += step.position;
+        if (!first_point) {
+            bbox.min = bbox.max = pos2point(convert(program_pos));
+            first_point = true;
         }
+        bbox += pos2point(convert(program_pos));
+        bbox += pos2point(convert(pos));
     }
 }
 
@@ -81,6 +79,17 @@ rs274_bounds::rs274_bounds(boost::program_options::variables_map& vm, bool cut,
  : rs274_base(vm), first_point(false), track_cut(cut), track_rapid(rapid) {
 }
 
+boost::program_options::options_description rs274_bounds::options() {
+    namespace po = boost::program_options;
+    po::options_description options("bounds options");
+    options.add_options()
+        ("cut,c", "track cuts in gcode")
+        ("rapid,r", "track rapids in gcode")
+        ("model,m", "calculate bounding box of model")
+    ;
+    return options;
+}
+
 cxxcam::Bbox rs274_bounds::bounding_box() const {
     return bbox;
 }
@@ -42,6 +42,8 @@ private:
 public:
 	rs274_bounds(boost::program_options::variables_map& vm, bool cut, bool rapid);
 
+    static boost::program_options::options_description options();
+
     cxxcam::Bbox bounding_box() const;
 
 	virtual ~rs274_bounds() = default;
@@ -24,6 +24,7 @@
 
 #include "rs274_clipper_path.h"
 #include "cxxcam/Path.h"
+#include "base/motion_steps.h"
 #include "base/machine_config.h"
 
 using namespace ClipperLib;
@@ -40,14 +41,10 @@ void rs274_clipper_path::_arc(const Position& end, const Position& center, const
         throw std::runtime_error("Helix not supported in path");
 
     using namespace cxxcam::path;
-	auto steps = expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation), {}).path;
-
     if (path_.empty())
         path_.emplace_back();
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::arc_steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation)))
         path_.back().push_back(scale_point(p));
-    }
 }
 
 
@@ -57,14 +54,10 @@ void rs274_clipper_path::_linear(const Position& pos) {
     if (std::abs(pos.z - program_pos.z) > 0)
         throw std::runtime_error("Path must be 2d");
 
-	auto steps = cxxcam::path::expand_linear(convert(program_pos), convert(pos), {}, -1).path;
-
     if (path_.empty())
         path_.emplace_back();
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::linear_steps(convert(program_pos), convert(pos)))
         path_.back().push_back(scale_point(p));
-    }
 }
 
 rs274_clipper_path::rs274_clipper_path(boost::program_options::variables_map& vm)
@@ -75,7 +68,7 @@ IntPoint rs274_clipper_path::scale_point(const cxxcam::math::point_3& p) const {
     using cxxcam::units::length_mm;
     using cxxcam::units::length_inch;
 
-    switch (machine_config::machine_units(config, machine_id)) {
+    switch (machine.length_units) {
         case machine_config::units::metric:
             return IntPoint(length_mm(p.x).value() * scale(), length_mm(p.y).value() * scale());
         case machine_config::units::imperial:
@@ -6,6 +6,7 @@
 #include <iostream>
 #include "clipper.hpp"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 #include <algorithm>
 #include "../r6.h"
 #include "common.h"
@@ -181,6 +182,7 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("tool_r,r", po::value<double>()->required(), "Tool radius")
@@ -202,6 +204,8 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
+        input_driver driver(vm);
+
         rs274_clipper_path nc_path(vm);
         double tool_offset = vm["tool_r"].as<double>() * 2 * vm["stepover"].as<double>();
         double cut_z = vm["cut_z"].as<double>();
@@ -213,23 +217,9 @@ int main(int argc, char* argv[]) {
 //        nc_path.read("G18");
 //        nc_path.execute();
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = nc_path.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cout << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = nc_path.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(nc_path);
+        if(status != RS274NGC_OK)
+            return status;
 
         auto paths = nc_path.path();
 
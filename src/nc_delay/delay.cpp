@@ -3,6 +3,7 @@
 #include <boost/program_options.hpp>
 #include "print_exception.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -17,6 +18,7 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("scale,s", po::value<double>()->default_value(1.0), "feed rate scale factor")
@@ -33,26 +35,16 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
-        rs274_delay delayer(vm, vm["scale"].as<double>(), vm.count("measure"));
+        input_driver driver(vm);
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
+        rs274_delay delayer(vm, vm["scale"].as<double>(), vm.count("measure"));
 
-            status = delayer.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cout << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = delayer.execute();
-            if(status != RS274NGC_OK)
-                return status;
+        auto status = driver.run(delayer, [](const char* line) {
             std::cout << line << "\n";
-        }
+            return true;
+        });
+        if(status != RS274NGC_OK)
+            return status;
 
         auto duration = delayer.cut_duration();
         auto hours = std::chrono::duration_cast<std::chrono::hours>(duration);
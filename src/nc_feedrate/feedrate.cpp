@@ -3,6 +3,8 @@
 #include <boost/program_options.hpp>
 #include "print_exception.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
+#include "tool_models.h"
 
 #include <iostream>
 #include <vector>
@@ -17,6 +19,9 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(tool_tolerance::options());
+    options.add(mesh_format::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("stock", po::value<std::string>()->required(), "Stock model file")
@@ -33,6 +38,8 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
+        input_driver driver(vm);
+
         rs274_feedrate rate(vm, vm["stock"].as<std::string>());
 
         if(vm.count("tool")) {
@@ -42,24 +49,12 @@ int main(int argc, char* argv[]) {
             rate.execute();
         }
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = rate.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cerr << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = rate.execute();
-            if(status != RS274NGC_OK)
-                return status;
+        auto status = driver.run(rate, [](const char* line) {
             std::cout << line << "\n";
-        }
+            return true;
+        });
+        if(status != RS274NGC_OK)
+            return status;
 
     } catch(const po::error& e) {
         print_exception(e);
@@ -26,6 +26,7 @@
 #include <cmath>
 #include <cstring>
 #include "cxxcam/Path.h"
+#include "base/motion_steps.h"
 #include "Simulation.h"
 #include <fstream>
 #include "throw_if.h"
@@ -37,9 +38,11 @@
 #include "geom/query.h"
 #include "geom/translate.h"
 #include <iostream>
+#include <sstream>
 #include "base/machine_config.h"
 
 #include "../r6.h"
+#include "mesh.h"
 std::ostream& operator<<(std::ostream& os, const geom::query::bbox_3& b) {
     os << "min: {" << r6(b.min.x) << ", " << r6(b.min.y) << ", " << r6(b.min.z) <<"} max: {" << r6(b.max.x) << ", " << r6(b.max.y) << ", " << r6(b.max.z) <<"}";
     return os;
@@ -111,14 +114,14 @@ double hm_face(double Kr, double ae, double fz, double Dcap) {
 
 void rs274_feedrate::_rapid(const Position& pos) {
     using namespace cxxcam;
-	auto steps = path::expand_linear(convert(program_pos), convert(pos), {}, -1).path;
+	motion::linear_steps steps(convert(program_pos), convert(pos));
 
 	auto length = path::length_linear(convert(program_pos), convert(pos));
     auto spindle_delta = spindle_delta_theta(length);
     apply_spindle_delta(spindle_delta);
 
     std::vector<bool> intersections;
-    fold_adjacent(std::begin(steps), std::end(steps), std::back_inserter(intersections), 
+    fold_adjacent(std::begin(steps.steps()), std::end(steps.steps()), std::back_inserter(intersections), 
 		[this](const path::step& s0, const path::step& s1) -> bool
 		{
 			auto toolpath = simulation::sweep_tool(_toolmodel + _tool_shank, s0, s1);
@@ -165,7 +168,7 @@ double rs274_feedrate::chip_load(const cxxcam::path::step& s0, const cxxcam::pat
         * calculate tool theta for step length at current rpm
         * bbox width on y axis is width of cut
         * */
-    auto tool_path = simulation::sweep_tool(_toolmodel, s0, s1);
+    auto tool_path = _convex ? simulation::sweep_tool(_convex_tool, s0, s1) : simulation::sweep_tool(_toolmodel, s0, s1);
     if(!intersects(tool_path, _model))
         return 0.0;
 
@@ -221,14 +224,14 @@ double rs274_feedrate::chip_load(const cxxcam::path::step& s0, const cxxcam::pat
 
 void rs274_feedrate::_arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation) {
     using namespace cxxcam;
-	auto steps = path::expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation), {}, 10).path;
+	motion::arc_steps steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation), 10);
 
 	auto length = path::length_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation));
     auto spindle_delta = spindle_delta_theta(length);
     auto spindle_step = spindle_delta / (steps.size() - 1);
 
     std::vector<double> chip_load_per_tooth;
-    fold_adjacent(std::begin(steps), std::end(steps), std::back_inserter(chip_load_per_tooth), 
+    fold_adjacent(std::begin(steps.steps()), std::end(steps.steps()), std::back_inserter(chip_load_per_tooth), 
 		[&, this](const path::step& s0, const path::step& s1) -> double
 		{
             return chip_load(s0, s1, spindle_step);
@@ -243,14 +246,14 @@ void rs274_feedrate::_arc(const Position& end, const Position& center, const cxx
 
 void rs274_feedrate::_linear(const Position& pos) {
     using namespace cxxcam;
-	auto steps = path::expand_linear(convert(program_pos), convert(pos), {}, 10).path;
+	motion::linear_steps steps(convert(program_pos), convert(pos), 10);
 
 	auto length = path::length_linear(convert(program_pos), convert(pos));
     auto spindle_delta = spindle_delta_theta(length);
     auto spindle_step = spindle_delta / (steps.size() - 1);
 
     std::vector<double> chip_load_per_tooth;
-    fold_adjacent(std::begin(steps), std::end(steps), std::back_inserter(chip_load_per_tooth), 
+    fold_adjacent(std::begin(steps.steps()), std::end(steps.steps()), std::back_inserter(chip_load_per_tooth), 
 		[&, this](const path::step& s0, const path::step& s1) -> double
 		{
             return chip_load(s0, s1, spindle_step);
@@ -264,19 +267,20 @@ void rs274_feedrate::_linear(const Position& pos) {
 void rs274_feedrate::tool_change(int slot) {
     using namespace machine_config;
 
-    switch (get_machine_type(config, machine_id)) {
+    switch (machine.type) {
         case machine_type::mill: {
             mill_tool& t = _tool.mill;
-            get_tool(config, slot, machine_id, t);
-            auto shank = geom::make_cone( {0, 0, t.length}, {0, 0, t.flute_length}, t.shank_diameter/2, t.shank_diameter/2, 32);
-            auto flutes = geom::make_cone( {0, 0, t.flute_length}, {0, 0, 0}, t.diameter/2, t.diameter/2, 32);
-            _toolmodel = flutes;
-            _tool_shank = shank;
+            get_tool(machine, slot, t);
+            auto& model = _tool_models.get(slot, t, _tolerance);
+            _toolmodel = model.flutes;
+            _tool_shank = model.shank;
+            _convex = model.is_convex;
+            _convex_tool = model.convex;
             break;
         }
         case machine_type::lathe: {
             lathe_tool &t = _tool.lathe;
-            get_tool(config, slot, machine_id, t);
+            get_tool(machine, slot, t);
             // TODO
             break;
         }
@@ -284,8 +288,8 @@ void rs274_feedrate::tool_change(int slot) {
 }
 
 rs274_feedrate::rs274_feedrate(boost::program_options::variables_map& vm, const std::string& stock_filename)
- : rs274_base(vm) {
-    std::ifstream is(stock_filename);
-    throw_if(!(is >> geom::format::off >> _model), "Unable to read stock from file");
+ : rs274_base(vm), _tolerance(tool_tolerance::get(vm)) {
+    std::ifstream is(stock_filename, std::ios::binary);
+    throw_if(!mesh::read(is, _model, mesh_format::get(vm, stock_filename)), "Unable to read stock from file");
 }
 
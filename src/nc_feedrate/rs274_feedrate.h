@@ -30,6 +30,8 @@
 #include <string>
 #include <vector>
 #include "base/machine_config.h"
+#include "Simulation.h"
+#include "tool_models.h"
 
 namespace cxxcam {
 namespace path {
@@ -41,8 +43,12 @@ class rs274_feedrate : public rs274_base
 {
 private:
     geom::polyhedron_t _model;
+    double _tolerance;
+    tool_models _tool_models;
     geom::polyhedron_t _toolmodel;
     geom::polyhedron_t _tool_shank;
+    cxxcam::simulation::convex_tool_t _convex_tool;
+    bool _convex = false;
     struct {
         machine_config::mill_tool mill;
         machine_config::lathe_tool lathe;
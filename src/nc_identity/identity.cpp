@@ -4,6 +4,7 @@
 #include "print_exception.h"
 #include "../throw_if.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -17,6 +18,8 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(input_driver::output_options());
     options.add_options()
         ("help,h", "display this help and exit")
     ;
@@ -31,25 +34,13 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
-        rs274_identity identity(vm);
+        input_driver driver(vm);
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
+        rs274_identity identity(vm);
 
-            status = identity.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cout << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = identity.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(identity);
+        if(status != RS274NGC_OK)
+            return status;
 
     } catch(const po::error& e) {
         print_exception(e);
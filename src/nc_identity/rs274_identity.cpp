@@ -23,7 +23,6 @@
  */
 
 #include "rs274_identity.h"
-#include <iostream>
 
 void rs274_identity::_rapid(const Position&) {
 }
@@ -35,8 +34,8 @@ void rs274_identity::_arc(const Position&, const Position&, const cxxcam::math::
 void rs274_identity::_linear(const Position&) {
 }
 
-void rs274_identity::block_end(const block_t& block) {
-    std::cout << str(block) << "\n";
+void rs274_identity::_block_end(const block_t& block) {
+    emit(block);
 }
 rs274_identity::rs274_identity(boost::program_options::variables_map& vm)
  : rs274_base(vm) {
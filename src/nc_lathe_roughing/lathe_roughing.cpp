@@ -4,6 +4,7 @@
 #include "../throw_if.h"
 #include "rs274_lathe_path.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -111,6 +112,7 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("stepdown,D", po::value<double>()->required(), "roughing stepdown")
@@ -127,28 +129,16 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
+        input_driver driver(vm);
+
         rs274_path nc_path(vm);
 
         nc_path.read("G18");
         nc_path.execute();
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = nc_path.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cerr << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = nc_path.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(nc_path);
+        if(status != RS274NGC_OK)
+            return status;
 
         auto start = nc_path.start();
         auto path = nc_path.path();
@@ -24,6 +24,7 @@
 
 #include "rs274_lathe_path.h"
 #include "cxxcam/Path.h"
+#include "base/motion_steps.h"
 #include "base/machine_config.h"
 
 using namespace ClipperLib;
@@ -36,7 +37,7 @@ void rs274_path::_rapid(const Position&) {
         using cxxcam::units::length_inch;
 
         auto p = convert(program_pos);
-        switch (machine_config::machine_units(config, machine_id)) {
+        switch (machine.length_units) {
             case machine_config::units::metric:
                 start_point_ = IntPoint(length_mm(p.X).value() * scale(), length_mm(p.Z).value() * scale());
                 break;
@@ -58,12 +59,8 @@ void rs274_path::_arc(const Position& end, const Position& center, const cxxcam:
         throw std::runtime_error("Single rotation only in path");
 
     using namespace cxxcam::path;
-	auto steps = expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation), {}).path;
-
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::arc_steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation)))
         path_.push_back(scale_point(p));
-    }
 }
 
 void rs274_path::_linear(const Position& pos) {
@@ -72,12 +69,8 @@ void rs274_path::_linear(const Position& pos) {
     if (std::abs(pos.y - program_pos.y) > 0)
         throw std::runtime_error("Path must be 2d");
 
-	auto steps = cxxcam::path::expand_linear(convert(program_pos), convert(pos), {}, -1).path;
-
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::linear_steps(convert(program_pos), convert(pos)))
         path_.push_back(scale_point(p));
-    }
 }
 
 rs274_path::rs274_path(boost::program_options::variables_map& vm)
@@ -88,7 +81,7 @@ IntPoint rs274_path::scale_point(const cxxcam::math::point_3& p) const {
     using cxxcam::units::length_mm;
     using cxxcam::units::length_inch;
 
-    switch (machine_config::machine_units(config, machine_id)) {
+    switch (machine.length_units) {
         case machine_config::units::metric:
             return IntPoint(length_mm(p.x).value() * scale(), length_mm(p.z).value() * scale());
         case machine_config::units::imperial:
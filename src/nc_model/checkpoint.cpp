@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * checkpoint.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "checkpoint.h"
+#include "geom/io.h"
+#include "throw_if.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+namespace checkpoint {
+
+namespace {
+
+const char* state_file = "state";
+const char* format_id = "nc_model-checkpoint 2";
+
+std::string path(const std::string& dir, const std::string& name) {
+    return dir + "/" + name;
+}
+
+/* Written beside the target and renamed over it, so a file named by the
+ * current state is never left partly written. */
+void write_off(const std::string& filename, const geom::polyhedron_t& poly) {
+    auto tmp = filename + ".tmp";
+    std::ofstream os(tmp);
+    throw_if(!(os << geom::format::off << poly), "Unable to write checkpoint: " + tmp);
+    os.close();
+    throw_if(!os, "Unable to write checkpoint: " + tmp);
+    throw_if(std::rename(tmp.c_str(), filename.c_str()) != 0, "Unable to write checkpoint: " + filename);
+}
+
+/* Distinguishes the files of this run from those of an earlier run in the
+ * same directory, whose state file may still name them. */
+const std::string& run_id() {
+    static const std::string id = std::to_string(::getpid()) + "-" + std::to_string(std::time(nullptr));
+    return id;
+}
+
+void read_off(const std::string& filename, geom::polyhedron_t& poly) {
+    std::ifstream is(filename);
+    throw_if(!(is >> geom::format::off >> poly), "Unable to read checkpoint: " + filename);
+}
+
+std::ostream& operator<<(std::ostream& os, const Position& p) {
+    return os << p.x << " " << p.y << " " << p.z << " " << p.a << " " << p.b << " " << p.c;
+}
+std::istream& operator>>(std::istream& is, Position& p) {
+    return is >> p.x >> p.y >> p.z >> p.a >> p.b >> p.c;
+}
+
+// Stock named by the current state, if any
+bool current_stock(const std::string& dir, std::string& stock) {
+    std::ifstream is(path(dir, state_file));
+    std::string line;
+    bool found = false;
+    while (std::getline(is, line)) {
+        std::istringstream s(line);
+        std::string key;
+        s >> key;
+        if (key == "stock")
+            found = static_cast<bool>(s >> stock);
+    }
+    return found;
+}
+
+}
+
+void save(const std::string& dir, const state& st, const geom::polyhedron_t& stock) {
+    throw_if(::mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST, "Unable to create checkpoint directory: " + dir);
+
+    std::string old_stock;
+    bool replace = current_stock(dir, old_stock);
+
+    auto stock_name = "stock-" + run_id() + "-" + std::to_string(st.blocks) + ".off";
+    write_off(path(dir, stock_name), stock);
+
+    auto tmp = path(dir, std::string(state_file) + ".tmp");
+    {
+        std::ofstream os(tmp);
+        os << std::setprecision(std::numeric_limits<double>::max_digits10);
+        os << format_id << "\n";
+        os << "blocks " << st.blocks << "\n";
+        os << "stock " << stock_name << "\n";
+        os << "program_pos " << st.program_pos << "\n";
+        os << "origin_pos " << st.origin_pos << "\n";
+        os << "units " << st.units << "\n";
+        os << "plane " << st.plane << "\n";
+        os << "motion_mode " << st.motion_mode << "\n";
+        os << "active_slot " << st.active_slot << "\n";
+        os << "coolant " << st.flood << " " << st.mist << "\n";
+        os << "feed_rate " << st.feed_rate << "\n";
+        os << "traverse_rate " << st.traverse_rate << "\n";
+        os << "spindle " << st.spindle_speed << " " << st.spindle_turning << " " << st.spindle_theta << "\n";
+        os.close();
+        throw_if(!os, "Unable to write checkpoint: " + tmp);
+    }
+    throw_if(std::rename(tmp.c_str(), path(dir, state_file).c_str()) != 0, "Unable to write checkpoint: " + tmp);
+
+    if (replace && old_stock != stock_name)
+        std::remove(path(dir, old_stock).c_str());
+}
+
+void load(const std::string& dir, state& st, geom::polyhedron_t& stock) {
+    auto filename = path(dir, state_file);
+    std::ifstream is(filename);
+    std::string line;
+    throw_if(!std::getline(is, line) || line != format_id, "Not a checkpoint: " + filename);
+
+    st = state{};
+    std::string stock_name;
+    while (std::getline(is, line)) {
+        std::istringstream s(line);
+        std::string key;
+        s >> key;
+        if (key == "blocks") s >> st.blocks;
+        else if (key == "stock") s >> stock_name;
+        else if (key == "program_pos") s >> st.program_pos;
+        else if (key == "origin_pos") s >> st.origin_pos;
+        else if (key == "units") s >> st.units;
+        else if (key == "plane") s >> st.plane;
+        else if (key == "motion_mode") s >> st.motion_mode;
+        else if (key == "active_slot") s >> st.active_slot;
+        else if (key == "coolant") s >> st.flood >> st.mist;
+        else if (key == "feed_rate") s >> st.feed_rate;
+        else if (key == "traverse_rate") s >> st.traverse_rate;
+        else if (key == "spindle") s >> st.spindle_speed >> st.spindle_turning >> st.spindle_theta;
+        else continue;
+        throw_if(!s, "Malformed checkpoint entry: " + line);
+    }
+    throw_if(stock_name.empty(), "Checkpoint has no stock: " + filename);
+
+    read_off(path(dir, stock_name), stock);
+}
+
+}
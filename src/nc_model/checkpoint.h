@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * checkpoint.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+#include "rs274ngc.hh"
+#include "geom/polyhedron.h"
+#include <string>
+#include <cstdint>
+
+/*
+ * Saved simulation progress for nc_model.
+ * A checkpoint directory holds the stock, with all motion up to the
+ * checkpoint removed, and a text state file naming it. The state file is
+ * replaced last, by rename, so an interrupted save leaves the previous
+ * checkpoint intact.
+ */
+namespace checkpoint {
+
+struct state {
+    // Blocks executed when the checkpoint was taken
+    std::uint64_t blocks = 0;
+
+    Position program_pos;
+    Position origin_pos;
+    int units = 0;
+    int plane = 0;
+    int motion_mode = 0;
+    int active_slot = 0;
+    int flood = 0;
+    int mist = 0;
+    double feed_rate = 0.0;
+    double traverse_rate = 0.0;
+    double spindle_speed = 0.0;
+    int spindle_turning = 0;
+    double spindle_theta = 0.0;
+};
+
+void save(const std::string& dir, const state& s, const geom::polyhedron_t& stock);
+
+/* Read the latest checkpoint in dir. */
+void load(const std::string& dir, state& s, geom::polyhedron_t& stock);
+
+}
+
+#endif /* CHECKPOINT_H_ */
@@ -0,0 +1,473 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dexel.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "dexel.h"
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <map>
+#include <utility>
+#include <ostream>
+#include "throw_if.h"
+#include "r6.h"
+#include "ray_parity.h"
+#include "mesh.h"
+
+namespace {
+
+using ray_parity::edge;
+using ray_parity::inside;
+
+typedef dexel_stock::point_3 point_3;
+typedef dexel_stock::interval interval;
+
+// Portions of a not covered by b
+std::vector<interval> subtract(const std::vector<interval>& a, const std::vector<interval>& b) {
+    std::vector<interval> result;
+    for (auto iv : a) {
+        for (auto& cut : b) {
+            if (cut.z1 <= iv.z0) continue;
+            if (cut.z0 >= iv.z1) break;
+            if (cut.z0 > iv.z0)
+                result.push_back({iv.z0, cut.z0});
+            iv.z0 = cut.z1;
+            if (iv.z0 >= iv.z1) break;
+        }
+        if (iv.z0 < iv.z1)
+            result.push_back(iv);
+    }
+    return result;
+}
+
+// Vertices lie on the vertical grid lines, numbered k along X and l along Y
+struct vertex_key {
+    unsigned k;
+    unsigned l;
+    double z;
+    bool operator==(const vertex_key& o) const {
+        return k == o.k && l == o.l && z == o.z;
+    }
+};
+struct vertex_hash {
+    std::size_t operator()(const vertex_key& v) const {
+        return std::hash<double>()(v.z) ^ (std::size_t(v.k) * 73856093) ^ (std::size_t(v.l) * 19349663);
+    }
+};
+
+/* Union find over face corners. */
+struct corner_sets {
+    std::vector<std::size_t> parent;
+    explicit corner_sets(std::size_t n) : parent(n) {
+        for (std::size_t i = 0; i < n; ++i)
+            parent[i] = i;
+    }
+    std::size_t find(std::size_t i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    }
+    void join(std::size_t a, std::size_t b) {
+        parent[find(a)] = find(b);
+    }
+};
+
+}
+
+dexel_stock::dexel_stock(const geom::object_t& model, double resolution)
+ : _x0(0), _y0(0), _resolution(resolution), _nx(0), _ny(0) {
+    throw_if(resolution <= 0, "Dexel resolution must be positive");
+    throw_if(model.vertices.empty(), "Empty stock model");
+
+    double x1 = model.vertices[0].x;
+    double y1 = model.vertices[0].y;
+    _x0 = x1;
+    _y0 = y1;
+    for (auto& v : model.vertices) {
+        _x0 = std::min(_x0, v.x);
+        _y0 = std::min(_y0, v.y);
+        x1 = std::max(x1, v.x);
+        y1 = std::max(y1, v.y);
+    }
+    _nx = std::max(1.0, std::ceil((x1 - _x0) / _resolution));
+    _ny = std::max(1.0, std::ceil((y1 - _y0) / _resolution));
+    _cells.resize(static_cast<std::size_t>(_nx) * _ny);
+
+    std::vector<std::vector<double>> hits(_cells.size());
+    auto rasterise = [&](point_3 a, point_3 b, point_3 c) {
+        auto area = edge(a, b, c.x, c.y);
+        if (area == 0)
+            return;     // Vertical face does not intersect a vertical ray
+        if (area < 0) {
+            std::swap(b, c);
+            area = -area;
+        }
+
+        auto i0 = first_cell(std::min({a.x, b.x, c.x}), _x0, _nx);
+        auto i1 = last_cell(std::max({a.x, b.x, c.x}), _x0, _nx);
+        auto j0 = first_cell(std::min({a.y, b.y, c.y}), _y0, _ny);
+        auto j1 = last_cell(std::max({a.y, b.y, c.y}), _y0, _ny);
+
+        for (auto j = j0; j < j1; ++j) {
+            auto y = cy(j);
+            for (auto i = i0; i < i1; ++i) {
+                auto x = cx(i);
+                auto wa = edge(b, c, x, y);
+                auto wb = edge(c, a, x, y);
+                auto wc = edge(a, b, x, y);
+                if (inside(wa, b, c) && inside(wb, c, a) && inside(wc, a, b)) {
+                    auto z = (wa * a.z + wb * b.z + wc * c.z) / area;
+                    hits[static_cast<std::size_t>(j) * _nx + i].push_back(z);
+                }
+            }
+        }
+    };
+
+    auto to_point = [&](std::size_t index) -> point_3 {
+        auto& v = model.vertices[index];
+        return {v.x, v.y, v.z};
+    };
+    for (auto& face : model.faces) {
+        if (face.vertices.size() < 3)
+            continue;
+        auto a = to_point(face.vertices[0]);
+        for (std::size_t k = 1; k + 1 < face.vertices.size(); ++k)
+            rasterise(a, to_point(face.vertices[k]), to_point(face.vertices[k+1]));
+    }
+
+    for (std::size_t c = 0; c < hits.size(); ++c) {
+        auto& z = hits[c];
+        std::sort(begin(z), end(z));
+        for (std::size_t k = 0; k + 1 < z.size(); k += 2) {
+            if (z[k] < z[k+1])
+                _cells[c].push_back({z[k], z[k+1]});
+        }
+    }
+}
+
+unsigned dexel_stock::first_cell(double v, double origin, unsigned n) const {
+    auto i = std::ceil((v - origin) / _resolution - 0.5);
+    return std::max(0.0, std::min<double>(n, i));
+}
+unsigned dexel_stock::last_cell(double v, double origin, unsigned n) const {
+    auto i = std::floor((v - origin) / _resolution - 0.5) + 1;
+    return std::max(0.0, std::min<double>(n, i));
+}
+
+void dexel_stock::remove(std::vector<interval>& cell, double z0, double z1) {
+    auto overlaps = [&](const interval& iv) { return iv.z1 > z0 && iv.z0 < z1; };
+    if (std::none_of(begin(cell), end(cell), overlaps))
+        return;
+
+    std::vector<interval> result;
+    result.reserve(cell.size() + 1);
+    for (auto& iv : cell) {
+        if (!overlaps(iv)) {
+            result.push_back(iv);
+            continue;
+        }
+        if (iv.z0 < z0)
+            result.push_back({iv.z0, z0});
+        if (iv.z1 > z1)
+            result.push_back({z1, iv.z1});
+    }
+    cell.swap(result);
+}
+
+void dexel_stock::cut_cylinder(const point_3& p0, const point_3& p1, double radius, double length) {
+    auto dx = p1.x - p0.x;
+    auto dy = p1.y - p0.y;
+    auto dz = p1.z - p0.z;
+    auto dd = dx*dx + dy*dy;
+    auto r2 = radius * radius;
+
+    auto i0 = first_cell(std::min(p0.x, p1.x) - radius, _x0, _nx);
+    auto i1 = last_cell(std::max(p0.x, p1.x) + radius, _x0, _nx);
+    auto j0 = first_cell(std::min(p0.y, p1.y) - radius, _y0, _ny);
+    auto j1 = last_cell(std::max(p0.y, p1.y) + radius, _y0, _ny);
+
+    for (auto j = j0; j < j1; ++j) {
+        auto ey = cy(j) - p0.y;
+        for (auto i = i0; i < i1; ++i) {
+            auto ex = cx(i) - p0.x;
+
+            /* Range of t in [0, 1] for which the cell center lies within the
+             * tool radius: |e - t*d|^2 <= r^2 */
+            double t0 = 0;
+            double t1 = 1;
+            if (dd == 0) {
+                if (ex*ex + ey*ey > r2)
+                    continue;
+            } else {
+                auto b = ex*dx + ey*dy;
+                auto c = ex*ex + ey*ey - r2;
+                auto disc = b*b - dd*c;
+                if (disc < 0)
+                    continue;
+                auto s = std::sqrt(disc);
+                t0 = std::max(0.0, (b - s) / dd);
+                t1 = std::min(1.0, (b + s) / dd);
+                if (t0 > t1)
+                    continue;
+            }
+
+            // Tip height is linear in t so the extremes lie at the range ends
+            auto za = p0.z + t0 * dz;
+            auto zb = p0.z + t1 * dz;
+            remove(cell(i, j), std::min(za, zb), std::max(za, zb) + length);
+        }
+    }
+}
+
+std::size_t dexel_stock::intervals() const {
+    std::size_t n = 0;
+    for (auto& c : _cells)
+        n += c.size();
+    return n;
+}
+
+/*
+ * Faces are the tops and bottoms of the intervals and the walls between
+ * cells. Walls meeting a vertical grid line are split at every z where a
+ * cell around the line starts or ends, so no vertex lies inside another
+ * face's edge. Cells touching only along an edge or at a corner share those
+ * positions, but not vertices: each fan of faces around a position gets its
+ * own vertex so the mesh is a closed 2-manifold.
+ */
+void dexel_stock::write_off(std::ostream& os) const {
+    typedef std::vector<std::size_t> face_t;
+
+    // Touching intervals would give coincident top and bottom faces
+    std::vector<std::vector<interval>> cells(_cells.size());
+    for (std::size_t c = 0; c < _cells.size(); ++c) {
+        for (auto& iv : _cells[c]) {
+            if (!cells[c].empty() && cells[c].back().z1 >= iv.z0)
+                cells[c].back().z1 = std::max(cells[c].back().z1, iv.z1);
+            else
+                cells[c].push_back(iv);
+        }
+    }
+    static const std::vector<interval> empty;
+    auto at = [&](long i, long j) -> const std::vector<interval>& {
+        if (i < 0 || j < 0 || i >= long(_nx) || j >= long(_ny))
+            return empty;
+        return cells[j * _nx + i];
+    };
+
+    auto nl = _nx + 1;
+    std::vector<std::vector<double>> breaks(nl * (_ny + 1));
+    for (unsigned l = 0; l <= _ny; ++l) {
+        for (unsigned k = 0; k <= _nx; ++k) {
+            auto& b = breaks[l * nl + k];
+            for (long j = long(l) - 1; j <= long(l); ++j) {
+                for (long i = long(k) - 1; i <= long(k); ++i) {
+                    for (auto& iv : at(i, j)) {
+                        b.push_back(iv.z0);
+                        b.push_back(iv.z1);
+                    }
+                }
+            }
+            std::sort(b.begin(), b.end());
+            b.erase(std::unique(b.begin(), b.end()), b.end());
+        }
+    }
+
+    std::unordered_map<vertex_key, std::size_t, vertex_hash> index;
+    std::vector<vertex_key> vertices;
+    std::vector<face_t> faces;
+
+    auto vertex = [&](unsigned k, unsigned l, double z) {
+        vertex_key v{k, l, z};
+        auto it = index.find(v);
+        if (it != index.end())
+            return it->second;
+        index.emplace(v, vertices.size());
+        vertices.push_back(v);
+        return vertices.size() - 1;
+    };
+    // Top or bottom of cell (i, j) at z
+    auto cap = [&](unsigned i, unsigned j, double z, bool up) {
+        face_t f = {vertex(i, j, z), vertex(i + 1, j, z), vertex(i + 1, j + 1, z), vertex(i, j + 1, z)};
+        if (!up)
+            std::reverse(f.begin(), f.end());
+        faces.push_back(std::move(f));
+    };
+    // Wall from line a to line b over [z0, z1], facing right of a -> b seen from above
+    auto wall = [&](unsigned ka, unsigned la, unsigned kb, unsigned lb, double z0, double z1) {
+        face_t f = {vertex(ka, la, z0), vertex(kb, lb, z0)};
+        for (auto z : breaks[lb * nl + kb])
+            if (z > z0 && z < z1)
+                f.push_back(vertex(kb, lb, z));
+        f.push_back(vertex(kb, lb, z1));
+        f.push_back(vertex(ka, la, z1));
+        auto& b = breaks[la * nl + ka];
+        for (auto z = b.rbegin(); z != b.rend(); ++z)
+            if (*z > z0 && *z < z1)
+                f.push_back(vertex(ka, la, *z));
+        faces.push_back(std::move(f));
+    };
+
+    for (unsigned j = 0; j < _ny; ++j) {
+        for (unsigned i = 0; i < _nx; ++i) {
+            for (auto& iv : at(i, j)) {
+                cap(i, j, iv.z1, true);
+                cap(i, j, iv.z0, false);
+            }
+        }
+    }
+
+    // Walls between cells (and the grid boundary) where material is exposed
+    for (unsigned j = 0; j < _ny; ++j) {
+        for (unsigned k = 0; k <= _nx; ++k) {
+            auto& left = at(long(k) - 1, j);
+            auto& right = at(k, j);
+            for (auto& iv : subtract(left, right))
+                wall(k, j, k, j + 1, iv.z0, iv.z1);
+            for (auto& iv : subtract(right, left))
+                wall(k, j + 1, k, j, iv.z0, iv.z1);
+        }
+    }
+    for (unsigned i = 0; i < _nx; ++i) {
+        for (unsigned k = 0; k <= _ny; ++k) {
+            auto& below = at(i, long(k) - 1);
+            auto& above = at(i, k);
+            for (auto& iv : subtract(below, above))
+                wall(i + 1, k, i, k, iv.z0, iv.z1);
+            for (auto& iv : subtract(above, below))
+                wall(i, k, i + 1, k, iv.z0, iv.z1);
+        }
+    }
+
+    auto position = [&](std::size_t v) -> mesh::point_3 {
+        auto& p = vertices[v];
+        return {_x0 + p.k * _resolution, _y0 + p.l * _resolution, p.z};
+    };
+
+    // Corners of each face, numbered from offset[f]
+    std::vector<std::size_t> offset;
+    std::size_t corners = 0;
+    std::vector<mesh::point_3> normals;
+    std::map<std::pair<std::size_t, std::size_t>, std::vector<std::pair<std::size_t, std::size_t>>> edges;
+    for (std::size_t f = 0; f < faces.size(); ++f) {
+        auto& face = faces[f];
+        offset.push_back(corners);
+        corners += face.size();
+        auto a = position(face[0]), b = position(face[1]), c = position(face[2]);
+        normals.push_back(mesh::cross(b - a, c - b));
+        for (std::size_t k = 0; k < face.size(); ++k)
+            edges[{face[k], face[(k + 1) % face.size()]}].push_back({f, k});
+    }
+
+    /* Each face is joined across an edge to the face bounding the same
+     * material: the one that lies on its inner side. Only edges where cells
+     * touch diagonally have more than one candidate. */
+    corner_sets sets(corners);
+    std::vector<std::array<std::size_t, 4>> contacts;
+    for (auto& e : edges) {
+        auto a = e.first.first;
+        auto b = e.first.second;
+        if (a > b)
+            continue;
+        auto twin = edges.find({b, a});
+        throw_if(twin == edges.end() || twin->second.size() != e.second.size(), "Unable to mesh dexel stock");
+        auto d = position(b) - position(a);
+        std::vector<bool> used(twin->second.size(), false);
+        for (auto& fk : e.second) {
+            auto& nf = normals[fk.first];
+            std::size_t m = 0;
+            while (m < used.size()) {
+                auto& g = twin->second[m];
+                if (!used[m] && (used.size() == 1 || mesh::dot(mesh::cross(normals[g.first], mesh::point_3{-d.x, -d.y, -d.z}), nf) < 0))
+                    break;
+                ++m;
+            }
+            throw_if(m == used.size(), "Unable to mesh dexel stock");
+            used[m] = true;
+            auto& g = twin->second[m];
+            auto ng = faces[g.first].size();
+            auto nf_size = faces[fk.first].size();
+            if (used.size() > 1)
+                contacts.push_back({{fk.first, fk.second, g.first, g.second}});
+            // f runs a -> b from corner k; g runs b -> a from corner m
+            sets.join(offset[fk.first] + fk.second, offset[g.first] + (g.second + 1) % ng);
+            sets.join(offset[fk.first] + (fk.second + 1) % nf_size, offset[g.first] + g.second);
+        }
+    }
+
+    std::unordered_map<std::size_t, std::size_t> split;
+    std::vector<mesh::point_3> points;
+    for (std::size_t f = 0; f < faces.size(); ++f) {
+        for (std::size_t k = 0; k < faces[f].size(); ++k) {
+            auto root = sets.find(offset[f] + k);
+            auto it = split.find(root);
+            if (it == split.end()) {
+                it = split.emplace(root, points.size()).first;
+                points.push_back(position(faces[f][k]));
+            }
+            faces[f][k] = it->second;
+        }
+    }
+
+    /* Where both ends of an edge of contact are single vertices the pairs of
+     * faces along it still share the edge; each pair gets its own midpoint. */
+    std::map<std::pair<std::size_t, std::size_t>, unsigned> shared;
+    for (auto& c : contacts) {
+        auto& f = faces[c[0]];
+        ++shared[{f[c[1]], f[(c[1] + 1) % f.size()]}];
+    }
+    std::map<std::pair<std::size_t, std::size_t>, std::size_t> midpoint;
+    for (auto& c : contacts) {
+        auto& f = faces[c[0]];
+        auto a = f[c[1]];
+        auto b = f[(c[1] + 1) % f.size()];
+        if (shared[{a, b}] < 2)
+            continue;
+        auto m = points.size();
+        points.push_back({(points[a].x + points[b].x) / 2, (points[a].y + points[b].y) / 2, (points[a].z + points[b].z) / 2});
+        midpoint[{c[0], c[1]}] = m;
+        midpoint[{c[2], c[3]}] = m;
+    }
+    if (!midpoint.empty()) {
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            face_t face;
+            for (std::size_t k = 0; k < faces[f].size(); ++k) {
+                face.push_back(faces[f][k]);
+                auto it = midpoint.find({f, k});
+                if (it != midpoint.end())
+                    face.push_back(it->second);
+            }
+            faces[f] = std::move(face);
+        }
+    }
+
+    os << "OFF\n" << points.size() << " " << faces.size() << " 0\n";
+    for (auto& v : points)
+        os << r6(v.x) << " " << r6(v.y) << " " << r6(v.z) << "\n";
+    for (auto& f : faces) {
+        os << f.size();
+        for (auto i : f)
+            os << " " << i;
+        os << "\n";
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * dexel.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef DEXEL_H_
+#define DEXEL_H_
+#include <vector>
+#include <cstddef>
+#include <iosfwd>
+#include "geom/polyhedron.h"
+
+/*
+ * Z-map (dexel) stock representation.
+ * The stock is sampled on a regular XY grid; each cell holds the sorted,
+ * disjoint material intervals along Z at the cell center.
+ * Memory is proportional to the number of cells (and the intervals in each)
+ * instead of the complexity of the cut.
+ */
+class dexel_stock
+{
+public:
+    struct point_3 {
+        double x;
+        double y;
+        double z;
+    };
+    struct interval {
+        double z0;
+        double z1;
+    };
+private:
+    double _x0;
+    double _y0;
+    double _resolution;
+    unsigned _nx;
+    unsigned _ny;
+    std::vector<std::vector<interval>> _cells;
+
+    std::vector<interval>& cell(unsigned i, unsigned j) { return _cells[j * _nx + i]; }
+    const std::vector<interval>& cell(unsigned i, unsigned j) const { return _cells[j * _nx + i]; }
+    double cx(unsigned i) const { return _x0 + (i + 0.5) * _resolution; }
+    double cy(unsigned j) const { return _y0 + (j + 0.5) * _resolution; }
+    // Cell range [first, last) whose centers lie within [v0, v1]
+    unsigned first_cell(double v0, double origin, unsigned n) const;
+    unsigned last_cell(double v1, double origin, unsigned n) const;
+    void remove(std::vector<interval>& cell, double z0, double z1);
+public:
+    /* Seed the grid by casting a ray in Z through each cell center of the model. */
+    dexel_stock(const geom::object_t& model, double resolution);
+
+    /* Remove the volume swept by a flat bottomed cylinder (end mill) of the
+     * given radius and length whose tip travels linearly from p0 to p1. */
+    void cut_cylinder(const point_3& p0, const point_3& p1, double radius, double length);
+
+    /* Mesh the grid as a closed set of axis aligned faces in OFF format. */
+    void write_off(std::ostream& os) const;
+
+    std::size_t cells() const { return _cells.size(); }
+    std::size_t intervals() const;
+};
+
+#endif /* DEXEL_H_ */
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * lathe_stock.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "lathe_stock.h"
+#include <cmath>
+#include <algorithm>
+#include <ostream>
+#include "throw_if.h"
+#include "r6.h"
+#include "Tool.h"
+
+namespace cl = ClipperLib;
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Integer units per mm
+const double scale_factor = 1e6;
+
+// Sweeps collected before they are subtracted from the profile
+const std::size_t batch_size = 256;
+
+}
+
+lathe_stock::lathe_stock(const geom::object_t& model, double tolerance)
+ : _tolerance(tolerance), _pending(0) {
+    throw_if(model.vertices.empty(), "Empty stock model");
+
+    double r = 0;
+    double z0 = model.vertices[0].z;
+    double z1 = z0;
+    for (auto& v : model.vertices) {
+        r = std::max(r, std::sqrt(v.x*v.x + v.y*v.y));
+        z0 = std::min(z0, v.z);
+        z1 = std::max(z1, v.z);
+    }
+    throw_if(r == 0 || z0 == z1, "Stock has no volume");
+
+    _profile.push_back({scale({0, z0}), scale({r, z0}), scale({r, z1}), scale({0, z1})});
+}
+
+cl::IntPoint lathe_stock::scale(const point_2& p) const {
+    return {static_cast<cl::cInt>(std::llround(p.x * scale_factor)), static_cast<cl::cInt>(std::llround(p.z * scale_factor))};
+}
+
+void lathe_stock::set_tool(double nose_radius) {
+    throw_if(nose_radius <= 0, "Lathe tool nose radius must be positive");
+    auto n = cxxcam::facets(2 * nose_radius, _tolerance);
+    _tool.clear();
+    for (int i = 0; i < n; ++i) {
+        auto a = 2 * PI * i / n;
+        _tool.push_back(scale({nose_radius * std::cos(a), nose_radius * std::sin(a)}));
+    }
+}
+
+void lathe_stock::cut(const std::vector<point_2>& path) {
+    throw_if(_tool.empty(), "No lathe tool selected");
+
+    /* The profile is the half X >= 0; a tool on the far side of the spindle
+     * cuts at its radius. Segments crossing the axis are split there so the
+     * folded path passes through it. */
+    cl::Path p;
+    auto add = [&](const point_2& pt) {
+        auto ip = scale({std::abs(pt.x), pt.z});
+        if (p.empty() || p.back() != ip)
+            p.push_back(ip);
+    };
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        if (i > 0) {
+            auto& a = path[i - 1];
+            auto& b = path[i];
+            if ((a.x < 0 && b.x > 0) || (a.x > 0 && b.x < 0)) {
+                auto t = a.x / (a.x - b.x);
+                add({0, a.z + (b.z - a.z) * t});
+            }
+        }
+        add(path[i]);
+    }
+    if (p.empty())
+        return;
+
+    if (p.size() == 1) {
+        cl::Path tool = _tool;
+        for (auto& t : tool) {
+            t.X += p[0].X;
+            t.Y += p[0].Y;
+        }
+        _cuts.push_back(std::move(tool));
+    } else {
+        cl::Paths swept;
+        cl::MinkowskiSum(_tool, p, swept, false);
+        _cuts.insert(_cuts.end(), swept.begin(), swept.end());
+    }
+
+    if (++_pending >= batch_size)
+        subtract();
+}
+
+void lathe_stock::subtract() {
+    if (_cuts.empty())
+        return;
+
+    cl::Clipper c;
+    c.AddPaths(_profile, cl::ptSubject, true);
+    c.AddPaths(_cuts, cl::ptClip, true);
+    cl::Paths result;
+    throw_if(!c.Execute(cl::ctDifference, result, cl::pftNonZero, cl::pftNonZero), "Unable to subtract lathe tool sweep");
+    _profile.swap(result);
+    _cuts.clear();
+    _pending = 0;
+}
+
+void lathe_stock::write_off(std::ostream& os) {
+    subtract();
+
+    cl::cInt r = 0;
+    for (auto& ring : _profile)
+        for (auto& p : ring)
+            r = std::max(r, p.X);
+    auto n = cxxcam::facets(2 * r / scale_factor, _tolerance);
+
+    struct vertex {
+        double x;
+        double y;
+        double z;
+    };
+    std::vector<vertex> vertices;
+    std::vector<std::vector<std::size_t>> faces;
+
+    for (auto& ring : _profile) {
+        // Points on the axis revolve to a single vertex
+        std::vector<std::size_t> first;
+        for (auto& p : ring) {
+            first.push_back(vertices.size());
+            double x = p.X / scale_factor;
+            double z = p.Y / scale_factor;
+            if (p.X <= 0) {
+                vertices.push_back({0, 0, z});
+                continue;
+            }
+            for (int k = 0; k < n; ++k) {
+                auto a = 2 * PI * k / n;
+                vertices.push_back({x * std::cos(a), x * std::sin(a), z});
+            }
+        }
+        auto index = [&](std::size_t i, int k) {
+            return ring[i].X <= 0 ? first[i] : first[i] + (k % n);
+        };
+
+        /* Outer rings run counter clockwise in XZ (holes clockwise); the
+         * band swept by each edge then faces out of the material. */
+        for (std::size_t i = 0; i < ring.size(); ++i) {
+            auto j = (i + 1) % ring.size();
+            if (ring[i].X <= 0 && ring[j].X <= 0)
+                continue;
+            for (int k = 0; k < n; ++k) {
+                std::vector<std::size_t> f = {index(i, k), index(i, k+1), index(j, k+1), index(j, k)};
+                f.erase(std::unique(f.begin(), f.end()), f.end());
+                if (f.size() > 1 && f.front() == f.back())
+                    f.pop_back();
+                if (f.size() >= 3)
+                    faces.push_back(std::move(f));
+            }
+        }
+    }
+
+    os << "OFF\n" << vertices.size() << " " << faces.size() << " 0\n";
+    for (auto& v : vertices)
+        os << r6(v.x) << " " << r6(v.y) << " " << r6(v.z) << "\n";
+    for (auto& f : faces) {
+        os << f.size();
+        for (auto i : f)
+            os << " " << i;
+        os << "\n";
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * lathe_stock.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef LATHE_STOCK_H_
+#define LATHE_STOCK_H_
+#include <vector>
+#include <iosfwd>
+#include "clipper.hpp"
+#include "geom/polyhedron.h"
+
+/*
+ * Turned stock kept as its half profile in the XZ plane (X radial, Z along
+ * the spindle axis). Turning removes a solid of revolution, so each tool
+ * sweep is subtracted in 2D and the profile is revolved into a mesh only
+ * when the model is written.
+ */
+class lathe_stock
+{
+public:
+    struct point_2 {
+        double x;
+        double z;
+    };
+private:
+    double _tolerance;
+    ClipperLib::Paths _profile;
+    ClipperLib::Path _tool;
+    // Swept regions not yet subtracted from the profile
+    ClipperLib::Paths _cuts;
+    std::size_t _pending;
+
+    ClipperLib::IntPoint scale(const point_2& p) const;
+    void subtract();
+public:
+    /* The stock is the cylinder about Z enclosing the model. */
+    lathe_stock(const geom::object_t& model, double tolerance);
+
+    /* Tool nose modelled as a circle about the programmed point. */
+    void set_tool(double nose_radius);
+
+    /* Remove the region swept by the tool along the polyline. X may be
+     * negative; the path is folded onto the profile as its radius. */
+    void cut(const std::vector<point_2>& path);
+
+    /* Revolve the profile into a closed mesh in OFF format. */
+    void write_off(std::ostream& os);
+};
+
+#endif /* LATHE_STOCK_H_ */
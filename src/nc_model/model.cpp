@@ -3,6 +3,8 @@
 #include <boost/program_options.hpp>
 #include "print_exception.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
+#include "tool_models.h"
 
 #include <iostream>
 #include <vector>
@@ -17,10 +19,27 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(tool_tolerance::options());
+    options.add(mesh_format::options());
     options.add_options()
         ("help,h", "display this help and exit")
-        ("stock", po::value<std::string>()->required(), "Stock model file")
+        ("stock", po::value<std::string>(), "Stock model file; taken from the checkpoint with --resume")
         ("tool", po::value<int>(), "Default tool")
+        ("engine", po::value<std::string>()->default_value("csg"), "Simulation engine [csg, dexel, lathe]")
+        ("resolution", po::value<double>()->default_value(0.1), "Dexel engine grid resolution")
+        ("check-sweep", "Verify convex tool sweeps against the general sweep")
+        ("coalesce-tolerance", po::value<double>()->default_value(0.001), "Merge collinear moves deviating less than this (mm) into one sweep; 0 to disable")
+        ("sweep-cache", po::value<unsigned>()->default_value(0), "Memory (MiB) for swept volumes of repeated moves; displacements within 1e-6 mm share a volume (default 0, off)")
+        ("checkpoint-every", po::value<unsigned>(), "Save the simulation state every N blocks")
+        ("checkpoint-dir", po::value<std::string>()->default_value("."), "Directory for checkpoints")
+        ("resume", "Continue from the checkpoint in --checkpoint-dir; the input must repeat the program up to it")
+        ("simplify-tolerance", po::value<double>()->default_value(0), "Weld vertices within this distance (mm) and merge coplanar faces of each folded toolpath; 0 to disable")
+        ("tiles", po::value<unsigned>()->default_value(1), "Subtract the toolpath from N slabs of the stock along its longest axis in parallel")
+        ("merge-order", po::value<std::string>()->default_value("morton"), "Order sweeps are grouped in for merging [morton, index]")
+        ("sweep-queue", po::value<unsigned>(), "Mill sweeps built ahead on the worker threads; 0 builds them on the interpreter thread (default 4 per core)")
+        ("batch", po::value<unsigned>(), "Subtract the toolpath from the stock in the background every N sweeps")
+        ("memory-budget", po::value<unsigned>(), "Resident memory (MiB) above which the in-flight toolpath is subtracted early")
     ;
 
     try {
@@ -33,7 +52,23 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
-        rs274_model modeler(vm, vm["stock"].as<std::string>());
+        input_driver driver(vm);
+
+        auto engine = [&] {
+            auto name = vm["engine"].as<std::string>();
+            if (name == "csg")
+                return rs274_model::Engine::csg;
+            if (name == "dexel")
+                return rs274_model::Engine::dexel;
+            if (name == "lathe")
+                return rs274_model::Engine::lathe;
+            throw std::runtime_error("Unrecognised engine: " + name);
+        }();
+
+        if(!vm.count("stock") && !vm.count("resume"))
+            throw po::required_option("stock");
+
+        rs274_model modeler(vm, vm.count("stock") ? vm["stock"].as<std::string>() : std::string{}, engine, vm["resolution"].as<double>(), vm.count("check-sweep"));
 
         if(vm.count("tool")) {
             std::stringstream s;
@@ -42,26 +77,14 @@ int main(int argc, char* argv[]) {
             modeler.execute();
         }
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = modeler.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cerr << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = modeler.execute();
-            if(status != RS274NGC_OK)
-                return status;
+        auto status = driver.run(modeler, [](const char* line) {
             std::cerr << line << "\n";
-        }
+            return true;
+        });
+        if(status != RS274NGC_OK)
+            return status;
 
-        std::cout << geom::format::off << modeler.model();
+        modeler.write_model(std::cout);
     } catch(const po::error& e) {
         print_exception(e);
         std::cout << options << "\n";
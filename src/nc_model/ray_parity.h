@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ray_parity.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef RAY_PARITY_H_
+#define RAY_PARITY_H_
+
+/*
+ * Point in triangle tests in XY for casting rays along Z through a mesh.
+ * Shared by the dexel seeding and the stock index; P is any type with
+ * x and y members.
+ */
+namespace ray_parity {
+
+// Twice the signed area of abp; positive if p is left of a->b
+template <typename P>
+double edge(const P& a, const P& b, double x, double y) {
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+/* Points exactly on an edge shared by two triangles must be counted once,
+ * otherwise the ray parity is broken. Exactly one direction of each edge owns
+ * the points on it. */
+template <typename P>
+bool owns_edge(const P& a, const P& b) {
+    return (b.y < a.y) || (b.y == a.y && b.x > a.x);
+}
+
+template <typename P>
+bool inside(double w, const P& a, const P& b) {
+    return w > 0 || (w == 0 && owns_edge(a, b));
+}
+
+}
+
+#endif /* RAY_PARITY_H_ */
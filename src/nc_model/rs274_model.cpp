@@ -26,19 +26,31 @@
 #include <cmath>
 #include <cstring>
 #include "cxxcam/Path.h"
+#include "base/motion_steps.h"
 #include "Simulation.h"
 #include <fstream>
 #include "throw_if.h"
 #include "geom/primitives.h"
 #include "fold_adjacent.h"
 #include "geom/ops.h"
+#include "geom/io.h"
+#include "geom/query.h"
 #include <thread>
 #include <future>
 #include <iterator>
 #include <algorithm>
+#include <atomic>
+#include <map>
 #include "base/machine_config.h"
+#include "thread_pool.h"
+#include "mesh.h"
+#include "base/stats.h"
+#include "checkpoint.h"
+#include "simplify.h"
 
 #include <iostream>
+#include <sstream>
+#include <unistd.h>
 
 namespace {
 
@@ -48,20 +60,178 @@ unsigned int hardware_concurrency() {
     return cores;
 }
 
+// Current resident set size in bytes, or 0 if it cannot be determined.
+std::size_t resident_memory() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    if (!(statm >> pages >> resident))
+        return 0;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+/* Polyhedra are never shared between threads; each sweep worker builds its
+ * own copy of a tool from the shared mesh the first time it sees it.
+ * Pool threads outlive the model, so entries hold the mesh weakly: one whose
+ * mesh has gone is rebuilt even if a new mesh took its address. */
+struct local_tool {
+    std::weak_ptr<const mesh::mesh_t> mesh;
+    geom::polyhedron_t model;
+    cxxcam::simulation::convex_tool_t convex;
+    bool is_convex;
+};
+const local_tool& get_local_tool(const std::shared_ptr<const mesh::mesh_t>& tool) {
+    thread_local std::map<const mesh::mesh_t*, local_tool> tools;
+    auto it = tools.find(tool.get());
+    if (it != tools.end() && it->second.mesh.lock() == tool)
+        return it->second;
+
+    for (auto e = tools.begin(); e != tools.end();) {
+        if (e->second.mesh.expired())
+            e = tools.erase(e);
+        else
+            ++e;
+    }
+    local_tool t;
+    t.mesh = tool;
+    t.model = mesh::to_polyhedron(*tool);
+    t.is_convex = cxxcam::simulation::make_convex_tool(t.model, *tool, t.convex);
+    return tools[tool.get()] = std::move(t);
+}
+
+geom::polyhedron_t sweep_mill_tool(const local_tool& tool, bool check_sweep, const cxxcam::path::step& s0, const cxxcam::path::step& s1) {
+    using namespace cxxcam;
+
+    if (!tool.is_convex || s0.orientation != s1.orientation)
+        return simulation::sweep_tool(tool.model, s0, s1);
+
+    if (check_sweep && !simulation::check_sweep(tool.convex, s0, s1)) {
+        using units::length_mm;
+        auto& p0 = s0.position;
+        auto& p1 = s1.position;
+        std::cerr << "Convex sweep differs from general sweep: "
+            << length_mm(p0.x).value() << " " << length_mm(p0.y).value() << " " << length_mm(p0.z).value() << " -> "
+            << length_mm(p1.x).value() << " " << length_mm(p1.y).value() << " " << length_mm(p1.z).value() << "\n";
+    }
+    return simulation::sweep_tool(tool.convex, s0, s1);
+}
+
+/* Everything a sweep worker needs, copied off the interpreter thread. */
+struct sweep_job {
+    std::shared_ptr<const mesh::mesh_t> tool;
+    int slot;
+    cxxcam::simulation::sweep_cache* cache;
+    bool check_sweep;
+    cxxcam::path::step s0;
+    cxxcam::path::step s1;
+
+    geom::polyhedron_t operator()() const {
+        if (!tool)
+            return {};
+        auto& t = get_local_tool(tool);
+        if (!cache)
+            return sweep_mill_tool(t, check_sweep, s0, s1);
+        // The cache is off while sweeps are checked, and keeps meshes
+        return cache->sweep_tool(slot, s0, s1, [&t](const cxxcam::path::step& a, const cxxcam::path::step& b) {
+            if (t.is_convex && a.orientation == b.orientation)
+                return cxxcam::simulation::sweep_mesh(t.convex, a, b);
+            return mesh::to_mesh(cxxcam::simulation::sweep_tool(t.model, a, b));
+        });
+    }
+};
+
+// Signed radial (X) and axial (Z) position for the lathe profile
+lathe_stock::point_2 to_profile(const cxxcam::math::point_3& p) {
+    using cxxcam::units::length_mm;
+    return {length_mm(p.x).value(), length_mm(p.z).value()};
+}
+
+/* Merged sweeps collect slivers and coplanar fragments that make the
+ * subtraction slower. Simplifying costs a conversion to a mesh and back, so
+ * it is done once on each folded toolpath rather than after every merge. */
+geom::polyhedron_t simplified(geom::polyhedron_t poly, double tolerance) {
+    if (tolerance <= 0)
+        return poly;
+    auto m = mesh::to_mesh(poly);
+    if (!simplify(m, tolerance))
+        return poly;
+    return mesh::to_polyhedron(m);
+}
+
+// Spread the low 21 bits of v to every third bit
+std::uint64_t spread_bits(std::uint64_t v) {
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8) & 0x100f00f00f00f00full;
+    v = (v | v << 4) & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2) & 0x1249249249249249ull;
+    return v;
 }
 
 /*
- * vector of future polyhedrons
- * queue of packaged_tasks
- * pool pulls tasks from queue
- * ...
- * */
-geom::polyhedron_t parallel_fold_toolpath(std::vector<geom::polyhedron_t> tool_motion);
+ * Order sweeps along a Morton (Z-order) curve through their bounding box
+ * centres. Contiguous ranges of the result are spatially compact, so chunks
+ * merge neighbouring, overlapping volumes at every level of the fold.
+ */
+void spatial_order(std::vector<geom::polyhedron_t>& tool_motion) {
+    if (tool_motion.size() < 3)
+        return;
+
+    std::vector<geom::point_3> centres;
+    centres.reserve(tool_motion.size());
+    for (auto& p : tool_motion) {
+        auto b = geom::bounding_box(p);
+        centres.push_back({(b.min.x + b.max.x) / 2, (b.min.y + b.max.y) / 2, (b.min.z + b.max.z) / 2});
+    }
+
+    auto lo = centres.front();
+    auto hi = centres.front();
+    for (auto& c : centres) {
+        lo = {std::min(lo.x, c.x), std::min(lo.y, c.y), std::min(lo.z, c.z)};
+        hi = {std::max(hi.x, c.x), std::max(hi.y, c.y), std::max(hi.z, c.z)};
+    }
+    // Common scale for all axes keeps cells cubic
+    auto extent = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z});
+    auto scale = extent > 0 ? 0x1fffff / extent : 0.0;
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> order;
+    order.reserve(centres.size());
+    for (std::size_t i = 0; i < centres.size(); ++i) {
+        auto& c = centres[i];
+        auto code = spread_bits((c.x - lo.x) * scale) |
+                    spread_bits((c.y - lo.y) * scale) << 1 |
+                    spread_bits((c.z - lo.z) * scale) << 2;
+        order.emplace_back(code, i);
+    }
+    // Ties keep their original order so the result is deterministic
+    std::sort(begin(order), end(order));
+
+    std::vector<geom::polyhedron_t> sorted;
+    sorted.reserve(tool_motion.size());
+    for (auto& o : order)
+        sorted.push_back(std::move(tool_motion[o.second]));
+    tool_motion = std::move(sorted);
+}
+
+// Longest run of moves merged into a single sweep
+const std::size_t max_run = 256;
+
+mesh::point_3 to_mm(const cxxcam::math::point_3& p) {
+    using cxxcam::units::length_mm;
+    return {length_mm(p.x).value(), length_mm(p.y).value(), length_mm(p.z).value()};
+}
+
+}
+
 std::vector<geom::polyhedron_t> parallel_fold_toolpath(unsigned int n, std::vector<geom::polyhedron_t> tool_motion);
 
 void rs274_model::_rapid(const Position& pos) {
     using namespace cxxcam;
 
+	if (_fast_forward)
+		return;
+
 	auto length = path::length_linear(convert(program_pos), convert(pos));
     auto spindle_delta = spindle_delta_theta(length);
     apply_spindle_delta(spindle_delta);
@@ -70,6 +240,9 @@ void rs274_model::_rapid(const Position& pos) {
 void rs274_model::_arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation) {
     using namespace cxxcam;
 
+	if (_fast_forward)
+		return;
+
 	auto length = path::length_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation));
     auto spindle_theta = _spindle_theta;
     auto spindle_delta = spindle_delta_theta(length);
@@ -77,27 +250,45 @@ void rs274_model::_arc(const Position& end, const Position& center, const cxxcam
     auto spindle_steps = (spindle_delta / (2*PI)) * _steps_per_revolution;
     auto spindle_step = spindle_delta / spindle_steps;
 
-	auto steps = path::expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation), {}, _lathe ? spindle_steps : 1).path;
+    if (_engine == Engine::lathe) {
+        motion::arc_steps steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation));
+        std::vector<lathe_stock::point_2> profile;
+        for (std::size_t i = 0; i < steps.size(); ++i)
+            profile.push_back(to_profile(steps.position(i)));
+        _lathe_stock->cut(profile);
+        return;
+    }
+
+    if (_engine == Engine::dexel) {
+        throw_if(end.a != 0 || end.b != 0 || end.c != 0, "Dexel engine supports 3 axis motion only");
+        motion::arc_steps steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation));
+        for (std::size_t i = 1; i < steps.size(); ++i)
+            dexel_cut(steps.position(i-1), steps.position(i));
+        return;
+    }
+
+	motion::arc_steps steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? path::ArcDirection::Clockwise : path::ArcDirection::CounterClockwise), plane, std::abs(rotation), _lathe ? spindle_steps : 1);
 
-    fold_adjacent(std::begin(steps), std::end(steps), std::back_inserter(_toolpath), 
-		[&](const path::step& s0, const path::step& s1) -> geom::polyhedron_t
+    for_each_adjacent(std::begin(steps.steps()), std::end(steps.steps()),
+		[&](const path::step& s0, const path::step& s1)
 		{
             if (_lathe) {
-                auto tp = simulation::sweep_lathe_tool(_tool, s0, s1, units::plane_angle(spindle_theta * units::radians));
+                _toolpath.push_back(simulation::sweep_lathe_tool(_tool, s0, s1, units::plane_angle(spindle_theta * units::radians)));
                 spindle_theta += spindle_step;
-                return tp;
             } else {
-                return simulation::sweep_tool(_tool, s0, s1);
+                add_sweep(s0, s1);
             }
 		});
-    if(_toolpath.size() >= 512 * hardware_concurrency())
-        _toolpath = parallel_fold_toolpath(hardware_concurrency(), _toolpath);
+    toolpath_added();
 }
 
 
 void rs274_model::_linear(const Position& pos) {
     using namespace cxxcam;
 
+	if (_fast_forward)
+		return;
+
 	auto length = path::length_linear(convert(program_pos), convert(pos));
     auto spindle_theta = _spindle_theta;
     auto spindle_delta = spindle_delta_theta(length);
@@ -105,22 +296,219 @@ void rs274_model::_linear(const Position& pos) {
     auto spindle_steps = (spindle_delta / (2*PI)) * _steps_per_revolution;
     auto spindle_step = spindle_delta / spindle_steps;
 
-	auto steps = path::expand_linear(convert(program_pos), convert(pos), {}, _lathe ? spindle_steps : -1).path;
+    if (_engine == Engine::lathe) {
+        auto p0 = convert(program_pos);
+        auto p1 = convert(pos);
+        _lathe_stock->cut({to_profile({p0.X, p0.Y, p0.Z}), to_profile({p1.X, p1.Y, p1.Z})});
+        return;
+    }
+
+    if (_engine == Engine::dexel) {
+        throw_if(pos.a != 0 || pos.b != 0 || pos.c != 0, "Dexel engine supports 3 axis motion only");
+        auto p0 = convert(program_pos);
+        auto p1 = convert(pos);
+        dexel_cut({p0.X, p0.Y, p0.Z}, {p1.X, p1.Y, p1.Z});
+        return;
+    }
+
+	motion::linear_steps steps(convert(program_pos), convert(pos), _lathe ? spindle_steps : -1);
 
-    fold_adjacent(std::begin(steps), std::end(steps), std::back_inserter(_toolpath), 
-		[&](const path::step& s0, const path::step& s1) -> geom::polyhedron_t
+    for_each_adjacent(std::begin(steps.steps()), std::end(steps.steps()),
+		[&](const path::step& s0, const path::step& s1)
 		{
             if (_lathe) {
-                auto tp = simulation::sweep_lathe_tool(_tool, s0, s1, units::plane_angle(spindle_theta * units::radians));
+                _toolpath.push_back(simulation::sweep_lathe_tool(_tool, s0, s1, units::plane_angle(spindle_theta * units::radians)));
                 spindle_theta += spindle_step;
-                return tp;
             } else {
-			    return simulation::sweep_tool(_tool, s0, s1);
+                add_sweep(s0, s1);
             }
 		});
-    if(_toolpath.size() >= 512 * hardware_concurrency())
-        _toolpath = parallel_fold_toolpath(hardware_concurrency(), _toolpath);
+    toolpath_added();
+}
+void rs274_model::toolpath_added() {
+    if (!_batch) {
+        if(_toolpath.size() >= 512 * hardware_concurrency()) {
+            if (_spatial_merge)
+                spatial_order(_toolpath);
+            _toolpath = parallel_fold_toolpath(hardware_concurrency(), std::move(_toolpath));
+        }
+        return;
+    }
+
+    if (_toolpath.size() >= _batch) {
+        subtract_toolpath();
+    } else if (_memory_budget && _toolpath.size() >= _budget_check) {
+        // Reading the resident size is not free; sample it every few sweeps.
+        _budget_check = _toolpath.size() + 64;
+        if (resident_memory() > _memory_budget)
+            subtract_toolpath();
+    }
+}
+
+void rs274_model::wait_subtraction() {
+    if (_subtraction.valid())
+        thread_pool::instance().get(_subtraction);
+}
+
+/*
+ * Hand the in-flight toolpath to a pool worker which merges it and removes it
+ * from the stock while interpretation continues.
+ * Only one subtraction runs at a time as each one modifies _model.
+ */
+void rs274_model::subtract_toolpath() {
+    wait_subtraction();
+    _budget_check = 64;
+    if (_toolpath.empty())
+        return;
+
+    auto batch = std::make_shared<std::vector<geom::polyhedron_t>>(std::move(_toolpath));
+    _toolpath.clear();
+    _subtraction = thread_pool::instance().submit([this, batch] {
+        subtract(std::move(*batch));
+        batch->clear();
+    });
+}
+
+/*
+ * Remove the sweeps from the stock. The culling index, if any, is rebuilt
+ * from the result so that it never describes material already cut.
+ */
+void rs274_model::subtract(std::vector<geom::polyhedron_t> sweeps) {
+    if (sweeps.empty())
+        return;
+    if (_tiles > 1) {
+        subtract_tiled(std::move(sweeps));
+    } else {
+        _model -= fold_toolpath(std::move(sweeps));
+    }
+    if (std::atomic_load(&_stock_index))
+        std::atomic_store(&_stock_index, std::make_shared<const stock_index>(mesh::to_mesh(_model)));
+}
+
+/*
+ * CAM output splits straight cuts into many short collinear moves.
+ * Consecutive sweeps at the same orientation are merged into one while every
+ * joint lies within the tolerance of the merged segment and progresses along
+ * it.
+ */
+bool rs274_model::extends_run(const cxxcam::path::step& s0, const cxxcam::path::step& s1) const {
+    if (!_run || _run_joints.size() >= max_run)
+        return false;
+    if (s0.orientation != _run_start.orientation || s1.orientation != s0.orientation)
+        return false;
+    auto joint = to_mm(s0.position);
+    auto end = to_mm(_run_end.position);
+    if (joint.x != end.x || joint.y != end.y || joint.z != end.z)
+        return false;
+
+    auto a = to_mm(_run_start.position);
+    auto b = to_mm(s1.position);
+    mesh::point_3 d = {b.x - a.x, b.y - a.y, b.z - a.z};
+    auto len2 = d.x*d.x + d.y*d.y + d.z*d.z;
+    if (len2 == 0)
+        return false;
+
+    auto tolerance2 = _coalesce_tolerance * _coalesce_tolerance;
+    double last = 0;
+    auto on_segment = [&](const mesh::point_3& p) {
+        mesh::point_3 e = {p.x - a.x, p.y - a.y, p.z - a.z};
+        auto t = (e.x*d.x + e.y*d.y + e.z*d.z) / len2;
+        if (t <= last || t >= 1)
+            return false;
+        last = t;
+        mesh::point_3 r = {e.x - t*d.x, e.y - t*d.y, e.z - t*d.z};
+        return r.x*r.x + r.y*r.y + r.z*r.z <= tolerance2;
+    };
+    for (auto& p : _run_joints)
+        if (!on_segment(p))
+            return false;
+    return on_segment(joint);
+}
+
+void rs274_model::add_sweep(const cxxcam::path::step& s0, const cxxcam::path::step& s1) {
+    if (_coalesce_tolerance > 0 && extends_run(s0, s1)) {
+        _run_joints.push_back(to_mm(s0.position));
+        _run_end = s1;
+        ++_coalesced;
+        return;
+    }
+
+    flush_run();
+    _run = true;
+    _run_start = s0;
+    _run_end = s1;
+}
+
+void rs274_model::flush_run() {
+    if (!_run)
+        return;
+    _run = false;
+    _run_joints.clear();
+
+    if (reaches_stock(_run_start, _run_end))
+        queue_sweep(_run_start, _run_end);
+    else
+        ++_culled;
+}
+
+/*
+ * Sweeps are built on the pool while interpretation continues. Results are
+ * taken in the order the moves were made, so the toolpath is the same as
+ * when every sweep is built on the interpreter thread.
+ */
+void rs274_model::queue_sweep(const cxxcam::path::step& s0, const cxxcam::path::step& s1) {
+    sweep_job job{_tool_mesh, _tool_slot, _sweep_cache.get(), _check_sweep, s0, s1};
+    if (!_sweep_queue) {
+        _toolpath.push_back(job());
+        return;
+    }
+    _sweeps.push_back(thread_pool::instance().submit(job));
+    collect_sweeps(_sweep_queue);
+}
+
+void rs274_model::collect_sweeps(std::size_t keep) {
+    auto& pool = thread_pool::instance();
+    while (_sweeps.size() > keep) {
+        _toolpath.push_back(pool.get(_sweeps.front()));
+        _sweeps.pop_front();
+    }
+}
+
+/* False if the sweep lies wholly in air; the tool box is taken about the tip
+ * with an orientation change bounded by the reach of the tool. */
+bool rs274_model::reaches_stock(const cxxcam::path::step& s0, const cxxcam::path::step& s1) const {
+    using namespace cxxcam;
+    using units::length_mm;
+    static const math::quaternion_t identity{1,0,0,0};
+
+    auto index = std::atomic_load(&_stock_index);
+    if (!index)
+        return true;
+
+    auto tool = _tool_bounds;
+    if (s0.orientation != identity)
+        tool = {{-_tool_reach, -_tool_reach, -_tool_reach}, {_tool_reach, _tool_reach, _tool_reach}};
+
+    auto& p0 = s0.position;
+    auto& p1 = s1.position;
+    double x0 = length_mm(p0.x).value(), y0 = length_mm(p0.y).value(), z0 = length_mm(p0.z).value();
+    double x1 = length_mm(p1.x).value(), y1 = length_mm(p1.y).value(), z1 = length_mm(p1.z).value();
+    stock_index::box sweep = {
+        {std::min(x0, x1) + tool.min.x, std::min(y0, y1) + tool.min.y, std::min(z0, z1) + tool.min.z},
+        {std::max(x0, x1) + tool.max.x, std::max(y0, y1) + tool.max.y, std::max(z0, z1) + tool.max.z}
+    };
+    return index->intersects(sweep);
+}
+
+void rs274_model::dexel_cut(const cxxcam::math::point_3& p0, const cxxcam::math::point_3& p1) {
+    using cxxcam::units::length_mm;
+
+    _dexel->cut_cylinder(
+        {length_mm(p0.x).value(), length_mm(p0.y).value(), length_mm(p0.z).value()},
+        {length_mm(p1.x).value(), length_mm(p1.y).value(), length_mm(p1.z).value()},
+        _cutter.radius, _cutter.length);
 }
+
 /* abstract out tool defs from models + add drill model where 'flutes' is tapered tip
  * */
 void rs274_model::tool_change(int slot) {
@@ -128,74 +516,422 @@ void rs274_model::tool_change(int slot) {
 
     if (_lathe) {
         lathe_tool t;
-        get_tool(config, slot, machine_id, t);
+        get_tool(machine, slot, t);
+        if (_lathe_stock)
+            _lathe_stock->set_tool(t.nose_radius);
         // TODO
     } else {
+        flush_run();
+
         mill_tool t;
-        get_tool(config, slot, machine_id, t);
-        auto shank = geom::make_cone( {0, 0, t.length}, {0, 0, t.flute_length}, t.shank_diameter/2, t.shank_diameter/2, 32);
-        auto flutes = geom::make_cone( {0, 0, t.flute_length}, {0, 0, 0}, t.diameter/2, t.diameter/2, 32);
-        //_tool = shank + flutes;
-        _tool = flutes;
+        get_tool(machine, slot, t);
+        _tool_slot = slot;
+        _cutter.radius = t.diameter/2;
+        _cutter.length = t.flute_length;
+        if (_engine == Engine::dexel)
+            return;
+
+        auto& model = _tool_models.get(slot, t, _tolerance);
+        //_tool = model.shank + model.flutes;
+        _tool_mesh = model.mesh;
+
+        // The faceted flutes lie within the cylinder
+        auto r = t.diameter/2;
+        _tool_bounds = {{-r, -r, 0}, {r, r, t.flute_length}};
+        _tool_reach = std::sqrt(r*r + t.flute_length*t.flute_length);
+    }
+}
+
+void rs274_model::_block_end(const block_t&) {
+    ++_blocks;
+    if (_fast_forward) {
+        if (--_fast_forward == 0)
+            restore_state();
+        return;
+    }
+    if (_checkpoint_every && _blocks % _checkpoint_every == 0)
+        save_checkpoint();
+}
+
+/*
+ * The toolpath not yet subtracted is merged and written with the stock so
+ * that resuming repeats none of the sweeps.
+ */
+void rs274_model::save_checkpoint() {
+    flush_run();
+    collect_sweeps(0);
+    // Only the motion since the last checkpoint is left to remove
+    if (_batch) {
+        subtract_toolpath();
+        wait_subtraction();
+    } else {
+        subtract(std::move(_toolpath));
+        _toolpath.clear();
     }
+
+    checkpoint::state st;
+    st.blocks = _blocks;
+    st.program_pos = program_pos;
+    st.origin_pos = origin_pos;
+    st.units = static_cast<int>(_length_unit_type);
+    st.plane = static_cast<int>(_active_plane);
+    st.motion_mode = static_cast<int>(_motion_mode);
+    st.active_slot = _tool_slot;
+    st.flood = _flood;
+    st.mist = _mist;
+    st.feed_rate = _feed_rate;
+    st.traverse_rate = _traverse_rate;
+    st.spindle_speed = _spindle_speed;
+    st.spindle_turning = static_cast<int>(_spindle_turning);
+    st.spindle_theta = _spindle_theta;
+
+    checkpoint::save(_checkpoint_dir, st, _model);
+}
+
+/*
+ * Reached the checkpoint block. The interpreter state has been rebuilt by
+ * executing the blocks before it; the simulation state comes from the
+ * checkpoint.
+ */
+void rs274_model::restore_state() {
+    auto& st = _resume;
+    program_pos = st.program_pos;
+    origin_pos = st.origin_pos;
+    _length_unit_type = static_cast<Units>(st.units);
+    _active_plane = static_cast<Plane>(st.plane);
+    _motion_mode = static_cast<Motion>(st.motion_mode);
+    _flood = st.flood;
+    _mist = st.mist;
+    _feed_rate = st.feed_rate;
+    _traverse_rate = st.traverse_rate;
+    _spindle_speed = st.spindle_speed;
+    _spindle_turning = static_cast<Direction>(st.spindle_turning);
+    _spindle_theta = st.spindle_theta;
+    if (st.active_slot != _tool_slot)
+        tool_change(st.active_slot);
 }
 
 void rs274_model::dwell(double /*seconds*/) {
     // TODO update spindle theta based on dwell time
 }
 
-rs274_model::rs274_model(boost::program_options::variables_map& vm, const std::string& stock_filename)
- : rs274_base(vm) {
-    std::ifstream is(stock_filename);
-    throw_if(!(is >> geom::format::off >> _model), "Unable to read stock from file");
+rs274_model::rs274_model(boost::program_options::variables_map& vm, const std::string& stock_filename, Engine engine, double resolution, bool check_sweep)
+ : rs274_base(vm), _engine(engine), _check_sweep(check_sweep) {
+    _lathe = machine.type == machine_config::machine_type::lathe;
+    _tolerance = tool_tolerance::get(vm);
 
-    auto type = machine_config::get_machine_type(config, machine_id);
-    _lathe = type == machine_config::machine_type::lathe;
+    if (vm.count("batch")) {
+        _batch = vm["batch"].as<unsigned>();
+        throw_if(!_batch, "Batch size must be positive");
+    }
+    if (vm.count("coalesce-tolerance")) {
+        _coalesce_tolerance = vm["coalesce-tolerance"].as<double>();
+        throw_if(_coalesce_tolerance < 0, "Coalesce tolerance must not be negative");
+    }
+    // Sweep diagnostics report positions so they bypass the cache
+    if (vm.count("sweep-cache") && !_check_sweep) {
+        auto budget = static_cast<std::size_t>(vm["sweep-cache"].as<unsigned>()) * 1024 * 1024;
+        if (budget)
+            _sweep_cache.reset(new cxxcam::simulation::sweep_cache(budget));
+    }
+    if (vm.count("merge-order")) {
+        auto order = vm["merge-order"].as<std::string>();
+        throw_if(order != "morton" && order != "index", "Unknown merge order: " + order);
+        _spatial_merge = order == "morton";
+    }
+    // Counting faces costs a conversion of every merged polyhedron
+    _record_merges = stats::active;
+    if (vm.count("simplify-tolerance")) {
+        _simplify_tolerance = vm["simplify-tolerance"].as<double>();
+        throw_if(_simplify_tolerance < 0, "Simplify tolerance must not be negative");
+    }
+    if (vm.count("tiles")) {
+        _tiles = vm["tiles"].as<unsigned>();
+        throw_if(!_tiles, "Tile count must be positive");
+        throw_if(_tiles > 1 && (_engine != Engine::csg || _lathe), "Tiles require the csg engine and a mill");
+    }
+    _sweep_queue = vm.count("sweep-queue") ? vm["sweep-queue"].as<unsigned>() : 4 * thread_pool::instance().size();
+    if (vm.count("memory-budget")) {
+        _memory_budget = static_cast<std::size_t>(vm["memory-budget"].as<unsigned>()) * 1024 * 1024;
+        if (!_batch)
+            _batch = 512 * hardware_concurrency();
+    }
+
+    if (vm.count("checkpoint-every")) {
+        _checkpoint_every = vm["checkpoint-every"].as<unsigned>();
+        throw_if(_engine != Engine::csg, "Checkpoints require the csg engine");
+    }
+    if (vm.count("checkpoint-dir"))
+        _checkpoint_dir = vm["checkpoint-dir"].as<std::string>();
+    bool resume = vm.count("resume");
+    throw_if(resume && _engine != Engine::csg, "Resume requires the csg engine");
+
+    _output_format = mesh_format::get(vm);
+    auto stock_format = mesh_format::get(vm, stock_filename);
+    std::ifstream is(stock_filename, std::ios::binary);
+    switch (_engine) {
+        case Engine::csg:
+            if (resume) {
+                checkpoint::load(_checkpoint_dir, _resume, _model);
+                _fast_forward = _resume.blocks;
+            } else {
+                throw_if(!mesh::read(is, _model, stock_format), "Unable to read stock from file");
+            }
+            if (!_lathe)
+                _stock_index = std::make_shared<const stock_index>(mesh::to_mesh(_model));
+            break;
+        case Engine::lathe: {
+            throw_if(!_lathe, "Lathe engine requires a lathe machine");
+            geom::object_t stock;
+            throw_if(!mesh::read(is, stock, stock_format), "Unable to read stock from file");
+            _lathe_stock.reset(new lathe_stock(stock, _tolerance));
+            break;
+        }
+        case Engine::dexel: {
+            throw_if(_lathe, "Dexel engine does not support lathe simulation");
+            geom::object_t stock;
+            throw_if(!mesh::read(is, stock, stock_format), "Unable to read stock from file");
+            _dexel.reset(new dexel_stock(stock, resolution));
+            break;
+        }
+    }
 }
 
 std::vector<geom::polyhedron_t> parallel_fold_toolpath(unsigned int n, std::vector<geom::polyhedron_t> tool_motion) {
     if(n == 1) return { geom::merge(tool_motion) };
-    if(tool_motion.size() == 1) return tool_motion;
+    if(tool_motion.size() <= n) return tool_motion;
 
-    unsigned int chunk_size = std::floor(tool_motion.size() / static_cast<double>(n));
+    auto& pool = thread_pool::instance();
+    unsigned int chunk_size = tool_motion.size() / n;
     unsigned int rem = tool_motion.size() % n;
-    
+
     typedef std::future<geom::polyhedron_t> polyhedron_future;
     std::vector<polyhedron_future> folded;
 
     for(unsigned int i = 0; i < n; ++i) {
+        auto begin = (chunk_size * i) + (i < rem ? i : rem);
+        auto end = (begin + chunk_size) + (i < rem ? 1 : 0);
 
-        std::packaged_task<geom::polyhedron_t()> fold([&tool_motion, chunk_size, rem, i]() {
-            auto begin = (chunk_size * i) + (i < rem ? i : rem);
-            auto end = (begin + chunk_size) + (i < rem ? 1 : 0);
-
-            return geom::merge(std::vector<geom::polyhedron_t>(std::make_move_iterator(tool_motion.begin() + begin), std::make_move_iterator(tool_motion.begin() + end)));
-        });
-
-        folded.push_back(fold.get_future());
-        std::thread(std::move(fold)).detach();
+        auto chunk = std::make_shared<std::vector<geom::polyhedron_t>>(std::make_move_iterator(tool_motion.begin() + begin), std::make_move_iterator(tool_motion.begin() + end));
+        folded.push_back(pool.submit([chunk]() {
+            return geom::merge(*chunk);
+        }));
     }
 
     std::vector<geom::polyhedron_t> result;
-    std::transform(begin(folded), end(folded), std::back_inserter(result), [](polyhedron_future& f){ return f.get(); });
+    std::transform(begin(folded), end(folded), std::back_inserter(result), [&pool](polyhedron_future& f){ return pool.get(f); });
     return result;
 }
-geom::polyhedron_t parallel_fold_toolpath(std::vector<geom::polyhedron_t> tool_motion) {
-    auto cores = hardware_concurrency();
-    while(cores > 1) {
-        tool_motion = parallel_fold_toolpath(cores, tool_motion);
-        cores /= 2;
+/*
+ * Balanced tree reduction on the shared pool.
+ * Each level queues several merges per worker so that work stealing can even
+ * out merges that take much longer than their siblings.
+ * Chunk results keep their order, so sweeps sorted once along the Morton
+ * curve stay spatially grouped at every level.
+ */
+geom::polyhedron_t rs274_model::fold_toolpath(std::vector<geom::polyhedron_t> tool_motion) {
+    auto& pool = thread_pool::instance();
+    if (_spatial_merge)
+        spatial_order(tool_motion);
+
+    unsigned level = 0;
+    while(tool_motion.size() > 1) {
+        auto groups = std::min<std::size_t>(tool_motion.size() / 2, pool.size() * 4);
+        if(groups <= 1) break;
+        auto start = std::chrono::steady_clock::now();
+        tool_motion = parallel_fold_toolpath(groups, std::move(tool_motion));
+        record_merge(level++, tool_motion, start);
     }
-    return geom::merge(tool_motion);
+    auto start = std::chrono::steady_clock::now();
+    auto merged = simplified(geom::merge(tool_motion), _simplify_tolerance);
+    record_merge(level, {merged}, start);
+    return merged;
+}
+
+/*
+ * Subtract the sweeps from the stock in _tiles slabs along its longest axis.
+ * Each slab is cut from the stock and loses only the sweeps whose bounds
+ * reach it, on its own worker; the slabs are then unioned back together.
+ * Workers build their own copies of the stock and of sweeps that span more
+ * than one slab rather than sharing polyhedra between threads.
+ */
+void rs274_model::subtract_tiled(std::vector<geom::polyhedron_t> sweeps) {
+    if (sweeps.empty())
+        return;
+
+    auto b = geom::bounding_box(_model);
+    double lo[] = {b.min.x, b.min.y, b.min.z};
+    double hi[] = {b.max.x, b.max.y, b.max.z};
+    unsigned axis = 0;
+    for (unsigned i = 1; i < 3; ++i)
+        if (hi[i] - lo[i] > hi[axis] - lo[axis])
+            axis = i;
+    auto step = (hi[axis] - lo[axis]) / _tiles;
+
+    struct tile {
+        double lo;
+        double hi;
+        std::vector<geom::polyhedron_t> sweeps;
+        std::vector<std::shared_ptr<const mesh::mesh_t>> shared;
+    };
+    std::vector<tile> tiles(_tiles);
+    for (unsigned i = 0; i < _tiles; ++i) {
+        tiles[i].lo = lo[axis] + step * i;
+        tiles[i].hi = i + 1 == _tiles ? hi[axis] : lo[axis] + step * (i + 1);
+    }
+
+    for (auto& sweep : sweeps) {
+        auto sb = geom::bounding_box(sweep);
+        double smin[] = {sb.min.x, sb.min.y, sb.min.z};
+        double smax[] = {sb.max.x, sb.max.y, sb.max.z};
+        std::vector<tile*> reached;
+        for (auto& t : tiles)
+            if (smin[axis] <= t.hi && smax[axis] >= t.lo)
+                reached.push_back(&t);
+        if (reached.empty())
+            continue;
+        if (reached.size() > 1) {
+            auto m = std::make_shared<const mesh::mesh_t>(mesh::to_mesh(sweep));
+            for (auto t = begin(reached) + 1; t != end(reached); ++t)
+                (*t)->shared.push_back(m);
+        }
+        reached.front()->sweeps.push_back(std::move(sweep));
+    }
+    sweeps.clear();
+
+    auto stock = std::make_shared<const mesh::mesh_t>(mesh::to_mesh(_model));
+    auto& pool = thread_pool::instance();
+    std::vector<std::future<geom::polyhedron_t>> cut;
+    for (unsigned i = 0; i < _tiles; ++i) {
+        auto t = std::make_shared<tile>(std::move(tiles[i]));
+        // Outer faces of the end slabs lie beyond the stock
+        double box_lo[] = {lo[0] - 1, lo[1] - 1, lo[2] - 1};
+        double box_hi[] = {hi[0] + 1, hi[1] + 1, hi[2] + 1};
+        if (i > 0)
+            box_lo[axis] = t->lo;
+        if (i + 1 < _tiles)
+            box_hi[axis] = t->hi;
+
+        cut.push_back(pool.submit([this, t, stock, box_lo, box_hi] {
+            auto slab = mesh::to_polyhedron(*stock) * geom::make_box({box_lo[0], box_lo[1], box_lo[2]}, {box_hi[0], box_hi[1], box_hi[2]});
+            for (auto& m : t->shared)
+                t->sweeps.push_back(mesh::to_polyhedron(*m));
+            if (!t->sweeps.empty())
+                slab -= fold_toolpath(std::move(t->sweeps));
+            return slab;
+        }));
+    }
+
+    std::vector<geom::polyhedron_t> slabs;
+    for (auto& f : cut)
+        slabs.push_back(pool.get(f));
+    _model = geom::merge(slabs);
+}
+
+void rs274_model::record_merge(unsigned level, const std::vector<geom::polyhedron_t>& merged, std::chrono::steady_clock::time_point start) {
+    if (!_record_merges)
+        return;
+    // Counted after the time is taken; geom has no face count, so it is read
+    // from the OFF header and the rest of the text is discarded
+    auto time = std::chrono::steady_clock::now() - start;
+    std::uint64_t faces = 0;
+    for (auto& p : merged)
+        faces += mesh::face_count(p);
+
+    std::lock_guard<std::mutex> lock(_merge_levels_m);
+    if (_merge_levels.size() <= level)
+        _merge_levels.resize(level + 1, {0, 0, std::chrono::steady_clock::duration::zero()});
+    auto& l = _merge_levels[level];
+    l.merges += merged.size();
+    l.faces += faces;
+    l.time += time;
 }
 
 geom::polyhedron_t rs274_model::model() {
-    if(!_toolpath.empty()) {
-        auto toolpath = parallel_fold_toolpath(_toolpath);
-        if (_lathe)
-        std::cerr << geom::format::off << toolpath;
+    throw_if(_fast_forward, "Input ended before the resumed checkpoint");
+    flush_run();
+    collect_sweeps(0);
+    toolpath_added();
+
+    if (stats::active && std::atomic_load(&_stock_index))
+        stats::active->counter("culled sweeps", _culled);
+    if (stats::active && _coalesce_tolerance > 0)
+        stats::active->counter("coalesced moves", _coalesced);
+    if (stats::active && _sweep_cache) {
+        stats::active->counter("sweep cache hits", _sweep_cache->hits());
+        stats::active->counter("sweep cache misses", _sweep_cache->misses());
+        auto lookups = _sweep_cache->hits() + _sweep_cache->misses();
+        stats::active->counter("sweep cache hit %", lookups ? (100 * _sweep_cache->hits()) / lookups : 0);
+    }
+
+    if (_dexel) {
+        std::stringstream s;
+        _dexel->write_off(s);
+        geom::polyhedron_t model;
+        throw_if(!(s >> geom::format::off >> model), "Unable to mesh dexel stock");
+        return model;
+    }
+    if (_lathe_stock) {
+        std::stringstream s;
+        _lathe_stock->write_off(s);
+        geom::polyhedron_t model;
+        throw_if(!(s >> geom::format::off >> model), "Unable to mesh lathe stock");
+        return model;
+    }
+
+    // Nothing more is culled; drop the index rather than rebuild it
+    std::atomic_store(&_stock_index, std::shared_ptr<const stock_index>());
+    if (_batch) {
+        subtract_toolpath();
+        wait_subtraction();
+    } else {
+        subtract(std::move(_toolpath));
         _toolpath.clear();
-        _model -= toolpath;
+    }
+
+    if (stats::active) {
+        for (std::size_t i = 0; i < _merge_levels.size(); ++i) {
+            auto& l = _merge_levels[i];
+            auto level = "merge level " + std::to_string(i);
+            stats::active->counter(level + " merges", l.merges);
+            stats::active->counter(level + " faces", l.faces);
+            stats::active->counter(level + " ms", std::chrono::duration_cast<std::chrono::milliseconds>(l.time).count());
+        }
     }
     return _model;
 }
+
+rs274_model::~rs274_model() {
+    // Queued sweeps refer to the sweep cache
+    for (auto& f : _sweeps)
+        if (f.valid())
+            f.wait();
+    // The pending subtraction refers to this object.
+    if (_subtraction.valid())
+        _subtraction.wait();
+}
+
+void rs274_model::write_model(std::ostream& os) {
+    if (!_dexel && !_lathe_stock) {
+        mesh::write(os, model(), _output_format);
+        return;
+    }
+
+    auto write_off = [&](std::ostream& os) {
+        if (_dexel)
+            _dexel->write_off(os);
+        else
+            _lathe_stock->write_off(os);
+    };
+    if (_output_format == mesh::format::off) {
+        write_off(os);
+        return;
+    }
+    // Parsed a line at a time as it is written
+    mesh::mesh_t m;
+    mesh::off_sink sink(m);
+    std::ostream s(&sink);
+    write_off(s);
+    throw_if(!sink.finish(), "Unable to mesh stock");
+    mesh::write(os, m, _output_format);
+}
@@ -26,31 +26,140 @@
 #define RS274_MODEL_H_
 #include "base/rs274_base.h"
 #include "cxxcam/Position.h"
+#include "cxxcam/Path.h"
+#include "mesh.h"
 #include "geom/polyhedron.h"
+#include "Simulation.h"
+#include "dexel.h"
+#include "lathe_stock.h"
+#include "stock_index.h"
+#include "tool_models.h"
+#include "checkpoint.h"
 #include <string>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 
 class rs274_model : public rs274_base
 {
+public:
+    enum class Engine {
+        csg,
+        dexel,
+        lathe
+    };
 private:
+    Engine _engine;
     geom::polyhedron_t _model;
+    std::unique_ptr<dexel_stock> _dexel;
+    std::unique_ptr<lathe_stock> _lathe_stock;
+    mesh::format _output_format = mesh::format::off;
+    struct {
+        double radius = 0.0;
+        double length = 0.0;
+    } _cutter;
+    double _tolerance;
+    tool_models _tool_models;
     geom::polyhedron_t _tool;
+    std::shared_ptr<const mesh::mesh_t> _tool_mesh;
+    stock_index::box _tool_bounds = {{0, 0, 0}, {0, 0, 0}};
+    double _tool_reach = 0.0;
+    int _tool_slot = 0;
+    std::unique_ptr<cxxcam::simulation::sweep_cache> _sweep_cache;
+    bool _check_sweep;
     std::vector<geom::polyhedron_t> _toolpath;
+
+    /* Mill sweeps being built by the pool, oldest first; at most
+     * _sweep_queue are outstanding. */
+    std::size_t _sweep_queue = 0;
+    std::deque<std::future<geom::polyhedron_t>> _sweeps;
+
+    /* Run of collinear mill moves not yet swept; _run_joints holds the
+     * interior points in mm. */
+    double _coalesce_tolerance = 0.0;
+    bool _run = false;
+    cxxcam::path::step _run_start;
+    cxxcam::path::step _run_end;
+    std::vector<mesh::point_3> _run_joints;
+    std::size_t _coalesced = 0;
+
+    /* Incremental mode; when _batch is set the toolpath is subtracted from the
+     * stock in the background every _batch sweeps, or sooner if the resident
+     * size passes _memory_budget bytes. */
+    std::size_t _batch = 0;
+    std::size_t _memory_budget = 0;
+    std::size_t _budget_check = 0;
+    std::future<void> _subtraction;
+
+    /* Sweeps are merged in Morton order of their bounds unless _spatial_merge
+     * is cleared, and the folded result is simplified when
+     * _simplify_tolerance is set. With --stats the faces and time of each
+     * merge level are totalled across every fold. */
+    struct merge_level {
+        std::uint64_t merges;
+        std::uint64_t faces;
+        std::chrono::steady_clock::duration time;
+    };
+    bool _spatial_merge = true;
+    double _simplify_tolerance = 0.0;
+    bool _record_merges = false;
+    std::mutex _merge_levels_m;
+    std::vector<merge_level> _merge_levels;
+
+    // Slabs the stock is split into for subtraction; 1 subtracts it whole
+    unsigned _tiles = 1;
+
+    /* Index of the stock for culling sweeps that cut only air; rebuilt
+     * whenever sweeps are subtracted from the stock. */
+    std::shared_ptr<const stock_index> _stock_index;
+    std::size_t _culled = 0;
+
+    /* Checkpoints are taken every _checkpoint_every blocks. On resume the
+     * blocks before the checkpoint are executed without simulating them. */
+    std::uint64_t _blocks = 0;
+    unsigned _checkpoint_every = 0;
+    std::string _checkpoint_dir = ".";
+    std::uint64_t _fast_forward = 0;
+    checkpoint::state _resume;
     unsigned _steps_per_revolution = 360;
     bool _lathe = false;
 
     virtual void _rapid(const Position& pos);
     virtual void _arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation);
     virtual void _linear(const Position& pos);
+    bool extends_run(const cxxcam::path::step& s0, const cxxcam::path::step& s1) const;
+    void add_sweep(const cxxcam::path::step& s0, const cxxcam::path::step& s1);
+    void flush_run();
+    bool reaches_stock(const cxxcam::path::step& s0, const cxxcam::path::step& s1) const;
+    void queue_sweep(const cxxcam::path::step& s0, const cxxcam::path::step& s1);
+    void collect_sweeps(std::size_t keep);
+    geom::polyhedron_t fold_toolpath(std::vector<geom::polyhedron_t> tool_motion);
+    void record_merge(unsigned level, const std::vector<geom::polyhedron_t>& merged, std::chrono::steady_clock::time_point start);
+    void subtract(std::vector<geom::polyhedron_t> sweeps);
+    void subtract_tiled(std::vector<geom::polyhedron_t> sweeps);
+    void toolpath_added();
+    void subtract_toolpath();
+    void wait_subtraction();
+    void save_checkpoint();
+    void restore_state();
+    void dexel_cut(const cxxcam::math::point_3& p0, const cxxcam::math::point_3& p1);
 	virtual void tool_change(int slot);
 	virtual void dwell(double seconds);
+    virtual void _block_end(const block_t& block);
 
 public:
-	rs274_model(boost::program_options::variables_map& vm, const std::string& stock_filename);
+	rs274_model(boost::program_options::variables_map& vm, const std::string& stock_filename, Engine engine = Engine::csg, double resolution = 0.1, bool check_sweep = false);
 
     geom::polyhedron_t model();
+    void write_model(std::ostream& os);
 
-	virtual ~rs274_model() = default;
+	virtual ~rs274_model();
 };
 
 #endif /* RS274_MODEL_H_ */
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * simplify.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "simplify.h"
+#include <unordered_map>
+#include <map>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+typedef mesh::point_3 point_3;
+typedef std::vector<std::size_t> face_t;
+typedef std::pair<std::size_t, std::size_t> edge_t;
+
+using mesh::dot;
+
+// Distance from its plane at which a face is no longer treated as planar
+const double planar_epsilon = 1e-9;
+
+/* Each directed edge used once and its reverse also present. */
+bool closed_manifold(const std::vector<face_t>& faces) {
+    std::map<edge_t, unsigned> edges;
+    for (auto& f : faces) {
+        for (std::size_t i = 0; i < f.size(); ++i) {
+            if (++edges[{f[i], f[(i + 1) % f.size()]}] > 1)
+                return false;
+        }
+    }
+    for (auto& e : edges)
+        if (!edges.count({e.first.second, e.first.first}))
+            return false;
+    return true;
+}
+
+/* Merge vertices within the tolerance of an earlier vertex, in vertex order.
+ * Returns the new index of each vertex. */
+std::vector<std::size_t> weld(std::vector<point_3>& vertices, double tolerance) {
+    typedef std::tuple<std::int64_t, std::int64_t, std::int64_t> cell_t;
+    struct cell_hash {
+        std::size_t operator()(const cell_t& c) const {
+            return std::hash<std::int64_t>()(std::get<0>(c) * 73856093 ^ std::get<1>(c) * 19349663 ^ std::get<2>(c) * 83492791);
+        }
+    };
+    auto cell = [&](const point_3& p) {
+        return cell_t(std::floor(p.x / tolerance), std::floor(p.y / tolerance), std::floor(p.z / tolerance));
+    };
+
+    std::unordered_map<cell_t, std::vector<std::size_t>, cell_hash> grid;
+    std::vector<point_3> welded;
+    std::vector<std::size_t> index(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        auto& p = vertices[i];
+        auto c = cell(p);
+        bool found = false;
+        for (int dx = -1; dx <= 1 && !found; ++dx) {
+            for (int dy = -1; dy <= 1 && !found; ++dy) {
+                for (int dz = -1; dz <= 1 && !found; ++dz) {
+                    auto it = grid.find(cell_t(std::get<0>(c) + dx, std::get<1>(c) + dy, std::get<2>(c) + dz));
+                    if (it == grid.end())
+                        continue;
+                    for (auto w : it->second) {
+                        auto d = welded[w] - p;
+                        if (dot(d, d) <= tolerance * tolerance) {
+                            index[i] = w;
+                            found = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        if (!found) {
+            index[i] = welded.size();
+            grid[c].push_back(welded.size());
+            welded.push_back(p);
+        }
+    }
+    vertices = std::move(welded);
+    return index;
+}
+
+/* Remap the faces and drop repeated vertices; faces left with fewer than
+ * three vertices are removed. */
+void remap(std::vector<face_t>& faces, const std::vector<std::size_t>& index) {
+    std::vector<face_t> remapped;
+    for (auto& f : faces) {
+        face_t r;
+        for (auto i : f) {
+            auto v = index[i];
+            if (r.empty() || r.back() != v)
+                r.push_back(v);
+        }
+        while (r.size() > 1 && r.front() == r.back())
+            r.pop_back();
+        if (r.size() >= 3)
+            remapped.push_back(std::move(r));
+    }
+    faces = std::move(remapped);
+}
+
+struct plane {
+    point_3 n;
+    double d;
+};
+
+// Newell's method; tolerant of non-convex and slightly non-planar faces
+plane face_plane(const std::vector<point_3>& v, const face_t& f) {
+    auto n = mesh::newell_normal(v, f);
+    point_3 c = {0, 0, 0};
+    for (auto i : f)
+        c = c + v[i];
+    auto len = std::sqrt(dot(n, n));
+    if (len > 0)
+        n = {n.x / len, n.y / len, n.z / len};
+    c = {c.x / f.size(), c.y / f.size(), c.z / f.size()};
+    return {n, dot(n, c)};
+}
+
+bool planar(const std::vector<point_3>& v, const face_t& f) {
+    auto p = face_plane(v, f);
+    for (auto i : f)
+        if (std::abs(dot(p.n, v[i]) - p.d) > planar_epsilon)
+            return false;
+    return true;
+}
+
+/* Welding moves vertices by up to the tolerance, which can bend a face out of
+ * its plane; such faces are split into triangles. Returns false if that
+ * leaves a triangle without area. */
+bool triangulate_bent(const std::vector<point_3>& v, std::vector<face_t>& faces) {
+    std::vector<face_t> result;
+    std::vector<std::size_t> triangles;
+    for (auto& f : faces) {
+        if (f.size() == 3 || planar(v, f)) {
+            result.push_back(std::move(f));
+            continue;
+        }
+        mesh::triangulate(v, f, triangles);
+        for (std::size_t t = 0; t < triangles.size(); t += 3) {
+            face_t tri{triangles[t], triangles[t + 1], triangles[t + 2]};
+            auto n = mesh::newell_normal(v, tri);
+            if (dot(n, n) == 0)
+                return false;
+            result.push_back(std::move(tri));
+        }
+    }
+    faces = std::move(result);
+    return true;
+}
+
+/* Replace regions of edge connected coplanar faces with their boundary.
+ * Regions whose boundary is not a single simple loop are left as they are. */
+void merge_coplanar(const std::vector<point_3>& v, std::vector<face_t>& faces) {
+    std::map<edge_t, std::size_t> edge_face;
+    for (std::size_t i = 0; i < faces.size(); ++i) {
+        auto& f = faces[i];
+        for (std::size_t k = 0; k < f.size(); ++k)
+            edge_face[{f[k], f[(k + 1) % f.size()]}] = i;
+    }
+
+    static const double parallel = 1 - 1e-9;
+    std::vector<plane> planes;
+    for (auto& f : faces)
+        planes.push_back(face_plane(v, f));
+    auto on_plane = [&](const plane& p, const face_t& f) {
+        for (auto i : f)
+            if (std::abs(dot(p.n, v[i]) - p.d) > planar_epsilon)
+                return false;
+        return true;
+    };
+
+    std::vector<std::size_t> region(faces.size(), faces.size());
+    std::vector<face_t> merged;
+    for (std::size_t seed = 0; seed < faces.size(); ++seed) {
+        if (region[seed] != faces.size())
+            continue;
+        auto& p = planes[seed];
+        std::vector<std::size_t> members{seed};
+        region[seed] = seed;
+        for (std::size_t m = 0; m < members.size(); ++m) {
+            auto& f = faces[members[m]];
+            for (std::size_t k = 0; k < f.size(); ++k) {
+                auto it = edge_face.find({f[(k + 1) % f.size()], f[k]});
+                if (it == edge_face.end())
+                    continue;
+                auto g = it->second;
+                if (region[g] != faces.size() || dot(planes[g].n, p.n) < parallel || !on_plane(p, faces[g]))
+                    continue;
+                region[g] = seed;
+                members.push_back(g);
+            }
+        }
+
+        auto keep = [&] {
+            for (auto m : members)
+                merged.push_back(faces[m]);
+        };
+        if (members.size() == 1) {
+            keep();
+            continue;
+        }
+
+        // Boundary edges are those whose reverse lies outside the region
+        std::map<std::size_t, std::size_t> next;
+        bool simple = true;
+        for (auto m : members) {
+            auto& f = faces[m];
+            for (std::size_t k = 0; k < f.size(); ++k) {
+                auto a = f[k];
+                auto b = f[(k + 1) % f.size()];
+                auto it = edge_face.find({b, a});
+                if (it != edge_face.end() && region[it->second] == seed)
+                    continue;
+                if (!next.emplace(a, b).second)
+                    simple = false;
+            }
+        }
+        if (!simple || next.empty()) {
+            keep();
+            continue;
+        }
+
+        face_t loop;
+        auto start = next.begin()->first;
+        auto at = start;
+        do {
+            loop.push_back(at);
+            auto it = next.find(at);
+            if (it == next.end() || loop.size() > next.size())
+                break;
+            at = it->second;
+        } while (at != start);
+        if (at != start || loop.size() != next.size()) {
+            keep();
+            continue;
+        }
+        merged.push_back(std::move(loop));
+    }
+    faces = std::move(merged);
+}
+
+}
+
+bool simplify(mesh::mesh_t& mesh, double tolerance) {
+    if (tolerance <= 0 || !closed_manifold(mesh.faces))
+        return false;
+
+    auto vertices = mesh.vertices;
+    auto faces = mesh.faces;
+    remap(faces, weld(vertices, tolerance));
+    if (!triangulate_bent(vertices, faces))
+        return false;
+    merge_coplanar(vertices, faces);
+
+    // Drop vertices no longer referenced
+    std::vector<std::size_t> index(vertices.size(), vertices.size());
+    std::vector<point_3> used;
+    for (auto& f : faces) {
+        for (auto& i : f) {
+            if (index[i] == vertices.size()) {
+                index[i] = used.size();
+                used.push_back(vertices[i]);
+            }
+            i = index[i];
+        }
+    }
+
+    if (faces.size() == mesh.faces.size() && used.size() == mesh.vertices.size())
+        return false;
+    if (faces.size() < 4 || !closed_manifold(faces))
+        return false;
+    mesh.vertices = std::move(used);
+    mesh.faces = std::move(faces);
+    return true;
+}
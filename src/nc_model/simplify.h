@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * simplify.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef SIMPLIFY_H_
+#define SIMPLIFY_H_
+#include "mesh.h"
+
+/*
+ * Reduce the faces of a closed mesh between boolean operations.
+ * Vertices closer than the tolerance are welded, which collapses short
+ * edges and drops the faces that degenerate. Faces the weld bends out of
+ * their plane are triangulated, then edge connected faces in a common plane
+ * are merged into one polygon.
+ * Vertices on merged boundaries are kept so neighbouring faces stay
+ * connected.
+ * The mesh is left unchanged, returning false, if it is not a closed
+ * manifold or would not be one after simplification.
+ */
+bool simplify(mesh::mesh_t& mesh, double tolerance);
+
+#endif /* SIMPLIFY_H_ */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stock_index.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "stock_index.h"
+#include <algorithm>
+#include <cmath>
+#include "ray_parity.h"
+
+namespace {
+
+using ray_parity::edge;
+using ray_parity::inside;
+
+typedef stock_index::point_3 point_3;
+typedef stock_index::box box;
+
+const unsigned leaf_size = 4;
+
+using mesh::cross;
+using mesh::dot;
+
+double axis(const point_3& p, unsigned i) {
+    return i == 0 ? p.x : (i == 1 ? p.y : p.z);
+}
+
+void extend(box& b, const point_3& p) {
+    b.min = {std::min(b.min.x, p.x), std::min(b.min.y, p.y), std::min(b.min.z, p.z)};
+    b.max = {std::max(b.max.x, p.x), std::max(b.max.y, p.y), std::max(b.max.z, p.z)};
+}
+void extend(box& b, const box& o) {
+    extend(b, o.min);
+    extend(b, o.max);
+}
+
+bool overlaps(const box& a, const box& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+           a.min.y <= b.max.y && a.max.y >= b.min.y &&
+           a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+/* Separating axis test between a triangle and a box given by its center and
+ * half extents (Akenine-Moller). Touching counts as overlapping. */
+bool overlaps(point_3 a, point_3 b, point_3 c, const point_3& center, const point_3& h) {
+    a = a - center;
+    b = b - center;
+    c = c - center;
+
+    auto separated = [&](const point_3& n) {
+        auto pa = dot(a, n);
+        auto pb = dot(b, n);
+        auto pc = dot(c, n);
+        auto r = h.x * std::abs(n.x) + h.y * std::abs(n.y) + h.z * std::abs(n.z);
+        return std::min({pa, pb, pc}) > r || std::max({pa, pb, pc}) < -r;
+    };
+
+    static const point_3 units[] = { {1, 0, 0}, {0, 1, 0}, {0, 0, 1} };
+    point_3 edges[] = { b - a, c - b, a - c };
+    for (auto& e : edges)
+        for (auto& u : units)
+            if (separated(cross(u, e)))
+                return false;
+    for (auto& u : units)
+        if (separated(u))
+            return false;
+    return !separated(cross(edges[0], edges[1]));
+}
+
+}
+
+stock_index::stock_index(const mesh::mesh_t& stock) {
+    auto& v = stock.vertices;
+    for (auto& face : stock.faces) {
+        for (std::size_t k = 1; k + 1 < face.size(); ++k)
+            _triangles.push_back({v[face[0]], v[face[k]], v[face[k+1]]});
+    }
+    if (!_triangles.empty())
+        build(0, _triangles.size());
+}
+
+unsigned stock_index::build(unsigned first, unsigned last) {
+    auto bounds = [](const triangle& t) {
+        box b{t.a, t.a};
+        extend(b, t.b);
+        extend(b, t.c);
+        return b;
+    };
+    auto centroid = [](const triangle& t, unsigned i) {
+        return axis(t.a, i) + axis(t.b, i) + axis(t.c, i);
+    };
+
+    auto index = static_cast<unsigned>(_nodes.size());
+    _nodes.push_back({});
+
+    auto b = bounds(_triangles[first]);
+    for (auto i = first + 1; i < last; ++i)
+        extend(b, bounds(_triangles[i]));
+    _nodes[index].bounds = b;
+
+    if (last - first <= leaf_size) {
+        _nodes[index].first = first;
+        _nodes[index].count = last - first;
+        return index;
+    }
+
+    // Median split across the longest side
+    auto size = b.max - b.min;
+    unsigned split = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+    auto mid = first + (last - first) / 2;
+    std::nth_element(begin(_triangles) + first, begin(_triangles) + mid, begin(_triangles) + last,
+        [&](const triangle& l, const triangle& r) { return centroid(l, split) < centroid(r, split); });
+
+    build(first, mid);
+    auto right = build(mid, last);
+    _nodes[index].count = 0;
+    _nodes[index].right = right;
+    return index;
+}
+
+bool stock_index::overlaps_face(const box& b) const {
+    point_3 center = {(b.min.x + b.max.x) / 2, (b.min.y + b.max.y) / 2, (b.min.z + b.max.z) / 2};
+    point_3 half = b.max - center;
+
+    std::vector<unsigned> stack{0};
+    while (!stack.empty()) {
+        auto& n = _nodes[stack.back()];
+        auto index = stack.back();
+        stack.pop_back();
+        if (!overlaps(n.bounds, b))
+            continue;
+        if (n.count) {
+            for (auto i = n.first; i < n.first + n.count; ++i) {
+                auto& t = _triangles[i];
+                if (overlaps(t.a, t.b, t.c, center, half))
+                    return true;
+            }
+        } else {
+            stack.push_back(index + 1);
+            stack.push_back(n.right);
+        }
+    }
+    return false;
+}
+
+/* Parity of a ray cast from p in +Z. */
+bool stock_index::contains(const point_3& p) const {
+    bool in = false;
+    std::vector<unsigned> stack{0};
+    while (!stack.empty()) {
+        auto index = stack.back();
+        auto& n = _nodes[index];
+        stack.pop_back();
+        if (p.x < n.bounds.min.x || p.x > n.bounds.max.x || p.y < n.bounds.min.y || p.y > n.bounds.max.y || p.z > n.bounds.max.z)
+            continue;
+        if (!n.count) {
+            stack.push_back(index + 1);
+            stack.push_back(n.right);
+            continue;
+        }
+        for (auto i = n.first; i < n.first + n.count; ++i) {
+            auto a = _triangles[i].a;
+            auto b = _triangles[i].b;
+            auto c = _triangles[i].c;
+            auto area = edge(a, b, c.x, c.y);
+            if (area == 0)
+                continue;   // Vertical face does not intersect a vertical ray
+            if (area < 0) {
+                std::swap(b, c);
+                area = -area;
+            }
+            auto wa = edge(b, c, p.x, p.y);
+            auto wb = edge(c, a, p.x, p.y);
+            auto wc = edge(a, b, p.x, p.y);
+            if (inside(wa, b, c) && inside(wb, c, a) && inside(wc, a, b)) {
+                auto z = (wa * a.z + wb * b.z + wc * c.z) / area;
+                if (z > p.z)
+                    in = !in;
+            }
+        }
+    }
+    return in;
+}
+
+bool stock_index::intersects(const box& b) const {
+    if (_nodes.empty() || !overlaps(_nodes[0].bounds, b))
+        return false;
+    if (overlaps_face(b))
+        return true;
+    // No face crosses the box so it is either wholly inside or wholly outside
+    return contains(b.min);
+}
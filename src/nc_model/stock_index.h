@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stock_index.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef STOCK_INDEX_H_
+#define STOCK_INDEX_H_
+#include <vector>
+#include "mesh.h"
+
+/*
+ * Bounding volume hierarchy over the faces of the stock.
+ * Answers whether an axis aligned box can touch the material so that sweeps
+ * through air are dropped before they reach the CSG merge.
+ * Material is only ever removed, so an index built from an earlier stock
+ * remains a conservative answer for the current one.
+ */
+class stock_index
+{
+public:
+    typedef mesh::point_3 point_3;
+    struct box {
+        point_3 min;
+        point_3 max;
+    };
+private:
+    struct triangle {
+        point_3 a;
+        point_3 b;
+        point_3 c;
+    };
+    struct node {
+        box bounds;
+        unsigned first;     // First triangle of a leaf
+        unsigned count;     // Triangle count of a leaf; zero for an inner node
+        unsigned right;     // Second child of an inner node; the first follows it
+    };
+
+    std::vector<triangle> _triangles;
+    std::vector<node> _nodes;
+
+    unsigned build(unsigned first, unsigned last);
+    bool overlaps_face(const box& b) const;
+    bool contains(const point_3& p) const;
+public:
+    explicit stock_index(const mesh::mesh_t& stock);
+
+    /* True if the box may intersect the stock material. */
+    bool intersects(const box& b) const;
+
+    bool empty() const { return _triangles.empty(); }
+};
+
+#endif /* STOCK_INDEX_H_ */
@@ -4,6 +4,7 @@
 #include "print_exception.h"
 #include "../throw_if.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -17,6 +18,7 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("from-tool,t", "From - Tool zero as rotational origin")
@@ -39,6 +41,10 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
+        input_driver driver(vm);
+        // Blocks are passed on as the source text, which a binary stream lacks
+        throw_if(driver.binary(), "Binary input is not supported");
+
         rotational_origin from;
         rotational_origin to;
 
@@ -55,22 +61,9 @@ int main(int argc, char* argv[]) {
 
         rs274_offset offset(vm, from, to);
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = offset.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    return status;
-                }
-            }
-            
-            status = offset.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(offset);
+        if(status != RS274NGC_OK)
+            return status;
 
     } catch(const po::error& e) {
         print_exception(e);
@@ -0,0 +1,213 @@
+#include "nc_identity/rs274_identity.h"
+#include "nc_rename_axis/rs274_rename.h"
+#include "nc_arcfit/rs274_arcfit.h"
+#include "nc_bounds/rs274_bounds.h"
+#include "rs274ngc_return.hh"
+#include <boost/program_options.hpp>
+#include "print_exception.h"
+#include "../throw_if.h"
+#include "base/machine_config.h"
+#include "base/input_driver.h"
+#include "base/block_sink.h"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+
+namespace po = boost::program_options;
+
+namespace {
+
+struct stage {
+    std::unique_ptr<rs274_base> interp;
+    // Work the standalone tool does after its input ends
+    std::function<void()> finish;
+    // Passes blocks on, rather than printing its own output
+    bool filter = true;
+};
+
+const char* separator = "!";
+const char* stage_names = "identity, rename_axis, arcfit, bounds";
+
+/* Options given before the first stage apply to every stage unless the
+ * stage sets them itself. */
+void inherit(const po::variables_map& global, po::variables_map& vm) {
+    for (auto name : {"config", "machine"}) {
+        auto it = global.find(name);
+        if (it == global.end() || it->second.defaulted())
+            continue;
+        auto existing = vm.find(name);
+        if (existing == vm.end() || existing->second.defaulted()) {
+            vm.erase(name);
+            vm.insert(*it);
+        }
+    }
+}
+
+stage make_stage(std::string name, const std::vector<std::string>& args, const po::variables_map& global, po::variables_map& vm) {
+    if (name.compare(0, 3, "nc_") == 0)
+        name.erase(0, 3);
+
+    po::options_description options("nc_pipe " + name);
+    options.add(machine_config::base_options());
+    options.add_options()
+        ("help,h", "display this help and exit")
+    ;
+
+    po::parsed_options parsed(nullptr);
+    auto parse = [&] {
+        parsed = po::command_line_parser(args).options(options).run();
+        store(parsed, vm);
+        if(vm.count("help")) {
+            std::cout << options << "\n";
+            return false;
+        }
+        notify(vm);
+        inherit(global, vm);
+        return true;
+    };
+
+    // A stage without an interpreter means help was displayed
+    stage s;
+    if (name == "identity") {
+        if (!parse()) return s;
+        s.interp.reset(new rs274_identity(vm));
+    } else if (name == "rename_axis") {
+        options.add(rs274_rename::options());
+        if (!parse()) return s;
+        s.interp.reset(new rs274_rename(vm, rs274_rename::parse_mods(parsed)));
+    } else if (name == "arcfit") {
+        options.add(rs274_arcfit::options());
+        if (!parse()) return s;
+        auto arcfit = new rs274_arcfit(vm);
+        s.interp.reset(arcfit);
+        s.finish = [arcfit] {
+            if (arcfit->read("M2") == RS274NGC_OK)
+                arcfit->execute();
+        };
+    } else if (name == "bounds") {
+        options.add(rs274_bounds::options());
+        if (!parse()) return s;
+        throw_if(vm.count("model"), "bounds --model cannot be used in a pipeline");
+        bool cut = vm.count("cut");
+        bool rapid = vm.count("rapid");
+        if(! (cut || rapid))
+            cut = true;
+        auto bounds = new rs274_bounds(vm, cut, rapid);
+        s.interp.reset(bounds);
+        s.filter = false;
+        s.finish = [bounds] {
+            std::cout << bounds->bounding_box() << "\n";
+        };
+    } else {
+        throw std::runtime_error("Unknown stage: " + name + " (expected one of " + stage_names + ")");
+    }
+    return s;
+}
+
+}
+
+/*
+ * Runs several filter tools in one process.
+ * nc_pipe [options] arcfit -c 0.05 ! rename_axis -s XY ! bounds
+ * behaves as nc_arcfit -c 0.05 | nc_rename_axis -s XY | nc_bounds
+ * Each stage takes the same options as the standalone tool; each block is
+ * handed to the next stage in memory as the canonical calls that make it,
+ * which the next interpreter replays without parsing (see interp_sink).
+ */
+int main(int argc, char* argv[]) {
+    po::options_description options("nc_pipe");
+    std::vector<std::string> args(argv, argv + argc);
+    args.erase(begin(args));
+
+    options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(input_driver::output_options());
+    options.add_options()
+        ("help,h", "display this help and exit")
+    ;
+
+    // Global options end at the first word that is not an option or its value
+    auto first_stage = begin(args);
+    while (first_stage != end(args) && first_stage->size() > 1 && (*first_stage)[0] == '-') {
+        // Long options are matched without dashes, short options with
+        auto name = first_stage->compare(0, 2, "--") == 0 ? first_stage->substr(2) : *first_stage;
+        auto has_value = name.find('=') != std::string::npos;
+        auto option = options.find_nothrow(name.substr(0, name.find('=')), false);
+        ++first_stage;
+        if (option && option->semantic()->max_tokens() > 0 && !has_value && first_stage != end(args))
+            ++first_stage;
+    }
+
+    try {
+        po::variables_map vm;
+        store(po::command_line_parser(std::vector<std::string>(begin(args), first_stage)).options(options).run(), vm);
+
+        if(vm.count("help") || first_stage == end(args)) {
+            std::cout << options << "\n";
+            std::cout << "stages: " << stage_names << "\n";
+            std::cout << "separate stages with '" << separator << "'\n";
+            return vm.count("help") ? 0 : 1;
+        }
+        notify(vm);
+
+        input_driver driver(vm);
+
+        std::vector<po::variables_map> stage_vm;
+        std::vector<stage> stages;
+        {
+            std::vector<std::vector<std::string>> stage_args(1);
+            for (auto it = first_stage; it != end(args); ++it) {
+                if (*it == separator)
+                    stage_args.emplace_back();
+                else
+                    stage_args.back().push_back(*it);
+            }
+            // Stages keep a reference to their variables_map
+            stage_vm.resize(stage_args.size());
+            for (std::size_t i = 0; i < stage_args.size(); ++i) {
+                auto& a = stage_args[i];
+                throw_if(a.empty(), "Empty pipeline stage");
+                std::vector<std::string> stage_options(begin(a) + 1, end(a));
+                stages.push_back(make_stage(a.front(), stage_options, vm, stage_vm[i]));
+                if (!stages.back().interp)
+                    return 0;
+            }
+        }
+        throw_if(vm["format"].as<std::string>() != "text" && !stages.back().filter, "--format applies only to a pipeline ending in a filter");
+
+        std::vector<std::unique_ptr<interp_sink>> sinks;
+        for (std::size_t i = 0; i + 1 < stages.size(); ++i) {
+            sinks.emplace_back(new interp_sink(*stages[i + 1].interp));
+            stages[i].interp->output(*sinks.back());
+        }
+        driver.output(*stages.back().interp);
+
+        /* A stage only finishes if its input ended cleanly, as the standalone
+         * tool returns early when the interpreter stops. Finishing a stage may
+         * pass more blocks downstream so the next status is read after. */
+        auto status = driver.run(*stages[0].interp);
+        auto result = status;
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            if (i > 0)
+                status = sinks[i - 1]->status();
+            if (status == RS274NGC_OK && stages[i].finish)
+                stages[i].finish();
+            if (result == RS274NGC_OK)
+                result = status;
+        }
+        if (result != RS274NGC_OK)
+            return result;
+    } catch(const po::error& e) {
+        print_exception(e);
+        std::cout << options << "\n";
+        return 1;
+    } catch(const std::exception& e) {
+        print_exception(e);
+        return 1;
+    }
+
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include "print_exception.h"
 #include "../throw_if.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -17,10 +18,11 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
+    options.add(input_driver::output_options());
+    options.add(rs274_rename::options());
     options.add_options()
         ("help,h", "display this help and exit")
-        ("delete,d", po::value<AxisModification>(), "delete axis [XYZABC]")
-        ("swap,s", po::value<AxisModification>(), "swap axes [XYZABC][XYZABC]")
     ;
 
     try {
@@ -34,41 +36,14 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        std::vector<AxisModification> mods;
-        auto is_none = [](AxisModification::Axis a) { return a == AxisModification::axis_None; };
-        for (auto& option : parsed.options) {
-            if (option.string_key == "delete") {
-                auto value = boost::lexical_cast<AxisModification>(option.value[0]);
-                if(is_none(value.from) || !is_none(value.to))
-                    throw std::runtime_error("Invalid axis specification for delete option");
-                mods.push_back(value);
-            } else if (option.string_key == "swap") {
-                auto value = boost::lexical_cast<AxisModification>(option.value[0]);
-                if(is_none(value.from) || is_none(value.to))
-                    throw std::runtime_error("Invalid axis specification for swap option");
-                mods.push_back(value);
-            }
-        }
+        auto mods = rs274_rename::parse_mods(parsed);
 
+        input_driver driver(vm);
         rs274_rename rename(vm, mods);
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = rename.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    std::cout << line <<"\n";
-                    return status;
-                }
-            }
-            
-            status = rename.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(rename);
+        if(status != RS274NGC_OK)
+            return status;
 
     } catch(const po::error& e) {
         print_exception(e);
@@ -25,6 +25,7 @@
 #include "rs274_rename.h"
 #include <iostream>
 #include <stdexcept>
+#include <boost/lexical_cast.hpp>
 
 AxisModification::Axis AxisModification::map(char c) {
     switch(c) {
@@ -100,17 +101,146 @@ void rs274_rename::apply_mods(block_t& block) const {
         apply_mod(mod, block);
 }
 
+/*
+ * Motion words of a renamed block are those of the original motion with the
+ * modifications applied, so an axis the block no longer names stays where
+ * the renamed program left it and an arc is centered on its (renamed) I, J,
+ * K from there, as when the renamed block is read.
+ */
+void rs274_rename::rename(canon::call& c, bool motion) {
+    using canon::op;
+    enum { X, Y, Z, A, B, C, I, J, K };
+    maybe<double> words[9];
+    auto apply = [&] {
+        auto word = [&](AxisModification::Axis a) -> maybe<double>* {
+            if (a == AxisModification::axis_None)
+                return nullptr;
+            return &words[a - AxisModification::axis_X];
+        };
+        for (auto& mod : mods) {
+            using std::swap;
+            auto from = word(mod.from);
+            auto to = word(mod.to);
+            if (from && to)
+                swap(*from, *to);
+            else if (from)
+                *from = maybe<double>();
+        }
+    };
+    auto set = [&](double& v, int w, double current) {
+        v = words[w] ? *words[w] : current;
+    };
+    auto offset = [&](int w) {
+        return words[w] ? *words[w] : 0.0;
+    };
+
+    switch (c.type) {
+        case op::offset_origin:
+            _renamed = _renamed + _renamed_origin - c.pos;
+            _renamed_origin = c.pos;
+            break;
+        case op::units: {
+            auto u = static_cast<Units>(c.integer);
+            if (u != _renamed_units) {
+                auto scale = u == Units::Imperial ? 1 / 25.4 : 25.4;
+                for (auto p : {&_renamed, &_renamed_origin}) {
+                    p->x *= scale;
+                    p->y *= scale;
+                    p->z *= scale;
+                }
+                _renamed_units = u;
+            }
+            break;
+        }
+        case op::rapid:
+        case op::linear:
+            if (motion) {
+                words[X] = c.pos.x; words[Y] = c.pos.y; words[Z] = c.pos.z;
+                words[A] = c.pos.a; words[B] = c.pos.b; words[C] = c.pos.c;
+                apply();
+                set(c.pos.x, X, _renamed.x); set(c.pos.y, Y, _renamed.y); set(c.pos.z, Z, _renamed.z);
+                set(c.pos.a, A, _renamed.a); set(c.pos.b, B, _renamed.b); set(c.pos.c, C, _renamed.c);
+            }
+            _renamed = c.pos;
+            break;
+        case op::probe:
+            _renamed = c.pos;
+            break;
+        case op::arc: {
+            Position end;
+            switch (_active_plane) {
+                case Plane::XY:
+                    end = Position(c.arc[0], c.arc[1], c.arc[4], c.pos.a, c.pos.b, c.pos.c);
+                    break;
+                case Plane::YZ:
+                    end = Position(c.arc[4], c.arc[0], c.arc[1], c.pos.a, c.pos.b, c.pos.c);
+                    break;
+                case Plane::XZ:
+                    end = Position(c.arc[1], c.arc[4], c.arc[0], c.pos.a, c.pos.b, c.pos.c);
+                    break;
+            }
+            words[X] = end.x; words[Y] = end.y; words[Z] = end.z;
+            words[A] = end.a; words[B] = end.b; words[C] = end.c;
+            words[I] = _arc_offset[0]; words[J] = _arc_offset[1]; words[K] = _arc_offset[2];
+            if (motion)
+                apply();
+            Position start = _renamed;
+            set(end.x, X, start.x); set(end.y, Y, start.y); set(end.z, Z, start.z);
+            set(end.a, A, start.a); set(end.b, B, start.b); set(end.c, C, start.c);
+            switch (_active_plane) {
+                case Plane::XY:
+                    c.arc[0] = end.x;
+                    c.arc[1] = end.y;
+                    c.arc[2] = start.x + offset(I);
+                    c.arc[3] = start.y + offset(J);
+                    c.arc[4] = end.z;
+                    break;
+                case Plane::YZ:
+                    c.arc[0] = end.y;
+                    c.arc[1] = end.z;
+                    c.arc[2] = start.y + offset(J);
+                    c.arc[3] = start.z + offset(K);
+                    c.arc[4] = end.x;
+                    break;
+                case Plane::XZ:
+                    c.arc[0] = end.z;
+                    c.arc[1] = end.x;
+                    c.arc[2] = start.z + offset(K);
+                    c.arc[3] = start.x + offset(I);
+                    c.arc[4] = end.y;
+                    break;
+            }
+            c.pos.a = end.a;
+            c.pos.b = end.b;
+            c.pos.c = end.c;
+            _renamed = end;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 void rs274_rename::_rapid(const Position&) {
 }
 
-void rs274_rename::_arc(const Position&, const Position&, const cxxcam::math::vector_3&, int) {
+void rs274_rename::_arc(const Position&, const Position& center, const cxxcam::math::vector_3& plane, int) {
+    // Center relative to the start, in the plane of the arc only
+    for (auto& offset : _arc_offset)
+        offset = maybe<double>();
+    if (!plane.x)
+        _arc_offset[0] = center.x - program_pos.x;
+    if (!plane.y)
+        _arc_offset[1] = center.y - program_pos.y;
+    if (!plane.z)
+        _arc_offset[2] = center.z - program_pos.z;
 }
 
 
 void rs274_rename::_linear(const Position&) {
 }
 
-void rs274_rename::block_end(const block_t& b) {
+void rs274_rename::_block_end(const block_t& b) {
     using std::swap;
     block_t block = b;
 
@@ -128,15 +258,54 @@ void rs274_rename::block_end(const block_t& b) {
                 motion_to_be == G_3;
     };
 
-    if (is_motion(block.motion_to_be))
+    auto motion = is_motion(block.motion_to_be);
+    if (motion)
         apply_mods(block);
 
     // TODO validate block is still valid after mods - e.g. no axis words with movement
     // must maintain non-axis words, e.g. feedrate
 
-    std::cout << str(block) << "\n";
+    if (!recording()) {
+        emit(block);
+        return;
+    }
+
+    auto renamed = calls();
+    for (auto& c : renamed)
+        rename(c, motion);
+    renamed.back().block = block;
+    emit(block, renamed);
 }
 rs274_rename::rs274_rename(boost::program_options::variables_map& vm, const std::vector<AxisModification>& mods)
- : rs274_base(vm), mods(mods) {
+ : rs274_base(vm), mods(mods), _renamed_units(_length_unit_type) {
+}
+
+boost::program_options::options_description rs274_rename::options() {
+    namespace po = boost::program_options;
+    po::options_description options("rename options");
+    options.add_options()
+        ("delete,d", po::value<AxisModification>(), "delete axis [XYZABC]")
+        ("swap,s", po::value<AxisModification>(), "swap axes [XYZABC][XYZABC]")
+    ;
+    return options;
+}
+
+std::vector<AxisModification> rs274_rename::parse_mods(const boost::program_options::parsed_options& parsed) {
+    std::vector<AxisModification> mods;
+    auto is_none = [](AxisModification::Axis a) { return a == AxisModification::axis_None; };
+    for (auto& option : parsed.options) {
+        if (option.string_key == "delete") {
+            auto value = boost::lexical_cast<AxisModification>(option.value[0]);
+            if(is_none(value.from) || !is_none(value.to))
+                throw std::runtime_error("Invalid axis specification for delete option");
+            mods.push_back(value);
+        } else if (option.string_key == "swap") {
+            auto value = boost::lexical_cast<AxisModification>(option.value[0]);
+            if(is_none(value.from) || is_none(value.to))
+                throw std::runtime_error("Invalid axis specification for swap option");
+            mods.push_back(value);
+        }
+    }
+    return mods;
 }
 
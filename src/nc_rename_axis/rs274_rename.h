@@ -62,15 +62,28 @@ private:
     std::vector<AxisModification> mods;
     void apply_mods(block_t& block) const;
 
+    /* State of the renamed program as read downstream, to make the calls of
+     * renamed blocks for a sink that needs them. */
+    Position _renamed;
+    Position _renamed_origin;
+    Units _renamed_units;
+    // I, J, K of the arc in the current block
+    maybe<double> _arc_offset[3];
+    void rename(canon::call& c, bool motion);
+
     virtual void _rapid(const Position& pos);
     virtual void _arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation);
     virtual void _linear(const Position& pos);
 
-    virtual void block_end(const block_t& block);
+    virtual void _block_end(const block_t& block);
 
 public:
 	rs274_rename(boost::program_options::variables_map& vm, const std::vector<AxisModification>& mods);
 
+    static boost::program_options::options_description options();
+    /* Axis modifications in command line order. */
+    static std::vector<AxisModification> parse_mods(const boost::program_options::parsed_options& parsed);
+
 	virtual ~rs274_rename() = default;
 };
 
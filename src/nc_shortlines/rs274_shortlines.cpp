@@ -29,6 +29,7 @@
 #include <chrono>
 #include <thread>
 #include "cxxcam/Path.h"
+#include "base/motion_steps.h"
 #include "../throw_if.h"
 #include "../r6.h"
 #include <iostream>
@@ -37,32 +38,23 @@
 void rs274_shortlines::_rapid(const Position& pos) {
     using namespace cxxcam::path;
 
-	auto steps = expand_linear(convert(program_pos), convert(pos), {}, 10).path;
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::linear_steps(convert(program_pos), convert(pos), 10))
         output_point(p, true);
-    }
 }
 
 void rs274_shortlines::_arc(const Position& end, const Position& center, const cxxcam::math::vector_3& plane, int rotation) {
     using namespace cxxcam::path;
 
-	auto steps = expand_arc(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation), {}, 10).path;
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::arc_steps(convert(program_pos), convert(end), convert(center), (rotation < 0 ? ArcDirection::Clockwise : ArcDirection::CounterClockwise), plane, std::abs(rotation), 10))
         output_point(p, false);
-    }
 }
 
 
 void rs274_shortlines::_linear(const Position& pos) {
     using namespace cxxcam::path;
 
-	auto steps = expand_linear(convert(program_pos), convert(pos), {}, 10).path;
-    for (auto& step : steps) {
-        auto& p = step.position;
+    for (auto p : motion::linear_steps(convert(program_pos), convert(pos), 10))
         output_point(p, false);
-    }
 }
 
 void rs274_shortlines::output_point(const cxxcam::math::point_3& p, bool rapid) const {
@@ -74,7 +66,7 @@ void rs274_shortlines::output_point(const cxxcam::math::point_3& p, bool rapid)
     else
         std::cout << "G1";
 
-    switch (machine_config::machine_units(config, machine_id)) {
+    switch (machine.length_units) {
         case machine_config::units::metric:
             std::cout << " X" << r6(length_mm(p.x).value());
             std::cout << " Y" << r6(length_mm(p.y).value());
@@ -3,6 +3,7 @@
 #include <boost/program_options.hpp>
 #include "print_exception.h"
 #include "base/machine_config.h"
+#include "base/input_driver.h"
 
 #include <iostream>
 #include <vector>
@@ -16,6 +17,7 @@ int main(int argc, char* argv[]) {
     args.erase(begin(args));
 
     options.add(machine_config::base_options());
+    options.add(input_driver::options());
     options.add_options()
         ("help,h", "display this help and exit")
     ;
@@ -30,24 +32,13 @@ int main(int argc, char* argv[]) {
         }
         notify(vm);
 
+        input_driver driver(vm);
+
         rs274_shortlines shortlines(vm);
 
-        std::string line;
-        while(std::getline(std::cin, line)) {
-            int status;
-
-            status = shortlines.read(line.c_str());
-            if(status != RS274NGC_OK) {
-                if(status != RS274NGC_EXECUTE_FINISH) {
-                    std::cerr << "Error reading line!: \n";
-                    return status;
-                }
-            }
-            
-            status = shortlines.execute();
-            if(status != RS274NGC_OK)
-                return status;
-        }
+        auto status = driver.run(shortlines);
+        if(status != RS274NGC_OK)
+            return status;
     } catch(const po::error& e) {
         print_exception(e);
         std::cout << options << "\n";
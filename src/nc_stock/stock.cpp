@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include "../throw_if.h"
+#include "mesh.h"
 
 namespace po = boost::program_options;
 
@@ -14,6 +15,7 @@ int main(int argc, char* argv[]) {
     std::vector<std::string> args(argv, argv + argc);
     args.erase(begin(args));
 
+    options.add(mesh_format::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("box", "Box stock shape")
@@ -46,7 +48,7 @@ int main(int argc, char* argv[]) {
             double y1 = vm["y1"].as<double>();
             double z1 = vm["z1"].as<double>();
             auto stock = geom::make_box({x0, y0, z0}, {x1, y1, z1});
-            std::cout << geom::format::off << stock;
+            mesh::write(std::cout, stock, mesh_format::get(vm));
         } else if(vm.count("cylinder")) {
             throw_if(!vm.count("radius"), "radius required for cylinder stock");
 
@@ -59,7 +61,7 @@ int main(int argc, char* argv[]) {
             double r = vm["radius"].as<double>();
             double s = vm["segments"].as<unsigned>();
             auto stock = geom::make_cone({x0, y0, z0}, {x1, y1, z1}, r, r, s);            
-            std::cout << geom::format::off << stock;
+            mesh::write(std::cout, stock, mesh_format::get(vm));
         } else {
             std::cerr << "must specify shape\n";
             return 1;
@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include "../throw_if.h"
+#include "mesh.h"
 #include "cxxcam/Math.h"
 #include "rs274_transform.h"
 
@@ -17,6 +18,7 @@ int main(int argc, char* argv[]) {
     std::vector<std::string> args(argv, argv + argc);
     args.erase(begin(args));
 
+    options.add(mesh_format::options());
     options.add_options()
         ("help,h", "display this help and exit")
         ("translate_x,x", po::value<double>(), "Translate along x axis")
@@ -40,8 +42,9 @@ int main(int argc, char* argv[]) {
         }
 
         if (vm.count("model")) {
+            auto format = mesh_format::get(vm);
             geom::polyhedron_t model;
-            throw_if(!(std::cin >> geom::format::off >> model), "Unable to read model from file");
+            throw_if(!mesh::read(std::cin, model, format), "Unable to read model from file");
 
             // apply transformations in order
             for (auto& option : parsed.options) {
@@ -67,7 +70,10 @@ int main(int argc, char* argv[]) {
                 }
             }
 
-            std::cout << model;
+            if (format == mesh::format::off)
+                std::cout << model;
+            else
+                mesh::write(std::cout, model, format);
         } else {
             // TODO store transformations / rotations in list
             // create rs274 transformer with transformations, go.
@@ -24,18 +24,71 @@
 
 #ifndef R6_H_
 #define R6_H_
-#include <sstream>
-#include <iomanip>
 #include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+/* Buffer large enough for any value formatted by r6 */
+const std::size_t r6_buffer_size = 328;
+
+/*
+ * Format v as fixed point with 6 decimals and trailing zeros removed.
+ * Writes to out (at least r6_buffer_size chars) and returns the end pointer.
+ * Scaling by 10^6 in double precision is exact enough to round correctly
+ * except near a halfway point, which is left to printf along with values
+ * too large for the fast path.
+ */
+inline char* r6(double v, char* out) {
+    auto trim = [](char* first, char* last) {
+        auto dot = static_cast<char*>(std::memchr(first, '.', last - first));
+        if (!dot) return last;
+        while (last[-1] == '0') --last;
+        if (last[-1] == '.') --last;
+        return last;
+    };
+
+    auto a = std::fabs(v);
+    if (a < 1e6) {
+        auto scaled = a * 1e6;
+        auto whole = std::floor(scaled);
+        auto frac = scaled - whole;
+        if (std::fabs(frac - 0.5) > 1e-3) {
+            auto n = static_cast<std::uint64_t>(whole) + (frac > 0.5 ? 1 : 0);
+            auto int_part = n / 1000000;
+            auto dec_part = static_cast<unsigned>(n % 1000000);
+
+            if (std::signbit(v)) *out++ = '-';
+
+            char digits[8];
+            char* d = digits + sizeof(digits);
+            do {
+                *--d = '0' + int_part % 10;
+                int_part /= 10;
+            } while (int_part);
+            while (d != digits + sizeof(digits)) *out++ = *d++;
+
+            if (dec_part) {
+                *out++ = '.';
+                for (int i = 5; i >= 0; --i) {
+                    out[i] = '0' + dec_part % 10;
+                    dec_part /= 10;
+                }
+                out += 6;
+                while (out[-1] == '0') --out;
+            }
+            return out;
+        }
+    }
+
+    auto n = std::snprintf(out, r6_buffer_size, "%.6f", v);
+    return trim(out, out + n);
+}
 
 inline std::string r6(double v) {
-    std::ostringstream ss;
-    ss << std::fixed << std::setprecision(6) << v;
-    auto s = ss.str();
-    
-    s.erase(s.find_last_not_of('0') + 1, std::string::npos);
-    if(s.back() == '.') s.pop_back();
-    return s;
+    char buf[r6_buffer_size];
+    return std::string(buf, r6(v, buf));
 }
 
 #endif /* R6_H_ */
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * thread_pool.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "thread_pool.h"
+
+namespace {
+
+// Index of the pool queue owned by the current thread, if any.
+thread_local const thread_pool* worker_pool = nullptr;
+thread_local unsigned worker_index = 0;
+
+}
+
+thread_pool::thread_pool(unsigned threads)
+ : _pending(0), _next(0), _stop(false) {
+    if (!threads) threads = 1;
+
+    for (unsigned i = 0; i < threads; ++i)
+        _queues.emplace_back(new queue);
+    for (unsigned i = 0; i < threads; ++i)
+        _threads.emplace_back([this, i]{ run(i); });
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(_m);
+        _stop = true;
+    }
+    _cv.notify_all();
+    for (auto& t : _threads)
+        t.join();
+}
+
+thread_pool& thread_pool::instance() {
+    static thread_pool pool([]{
+        auto cores = std::thread::hardware_concurrency();
+        return cores ? cores : 4;
+    }());
+    return pool;
+}
+
+unsigned thread_pool::size() const {
+    return _threads.size();
+}
+
+void thread_pool::push(task t) {
+    // Tasks spawned by a worker stay local to it; others are spread round robin.
+    auto index = worker_pool == this ? worker_index : _next++ % _queues.size();
+    {
+        // Count first so the pending total never drops below the queued tasks.
+        std::lock_guard<std::mutex> lock(_m);
+        ++_pending;
+    }
+    {
+        auto& q = *_queues[index];
+        std::lock_guard<std::mutex> lock(q.m);
+        q.tasks.push_back(std::move(t));
+    }
+    _cv.notify_one();
+}
+
+bool thread_pool::pop(unsigned index, task& t) {
+    {
+        auto& q = *_queues[index];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (!q.tasks.empty()) {
+            t = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            --_pending;
+            return true;
+        }
+    }
+    for (unsigned i = 1; i < _queues.size(); ++i) {
+        auto& q = *_queues[(index + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (!q.tasks.empty()) {
+            t = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            --_pending;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool thread_pool::run_pending_task() {
+    task t;
+    auto index = worker_pool == this ? worker_index : _next % _queues.size();
+    if (!pop(index, t))
+        return false;
+    t();
+    return true;
+}
+
+void thread_pool::run(unsigned index) {
+    worker_pool = this;
+    worker_index = index;
+
+    while (true) {
+        task t;
+        if (pop(index, t)) {
+            t();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_m);
+        _cv.wait(lock, [this]{ return _stop || _pending > 0; });
+        if (_stop && _pending == 0)
+            return;
+    }
+}
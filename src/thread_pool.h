@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * thread_pool.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Fixed set of worker threads, each with its own task deque.
+ * Workers take from the back of their own deque and steal from the front of
+ * the others when it runs dry, so uneven tasks do not leave cores idle.
+ */
+class thread_pool
+{
+private:
+    typedef std::function<void()> task;
+    struct queue {
+        std::mutex m;
+        std::deque<task> tasks;
+    };
+
+    std::vector<std::unique_ptr<queue>> _queues;
+    std::vector<std::thread> _threads;
+
+    std::mutex _m;
+    std::condition_variable _cv;
+    std::atomic<unsigned> _pending;
+    std::atomic<unsigned> _next;
+    bool _stop;
+
+    void push(task t);
+    bool pop(unsigned index, task& t);
+    void run(unsigned index);
+public:
+    explicit thread_pool(unsigned threads);
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool();
+
+    /* Process wide pool sized to the hardware concurrency. */
+    static thread_pool& instance();
+
+    unsigned size() const;
+
+    template <typename Fn>
+    std::future<typename std::result_of<Fn()>::type> submit(Fn fn) {
+        typedef typename std::result_of<Fn()>::type result_type;
+        auto job = std::make_shared<std::packaged_task<result_type()>>(std::move(fn));
+        auto result = job->get_future();
+        push([job]{ (*job)(); });
+        return result;
+    }
+
+    /* Execute one queued task on the calling thread.
+     * Returns false if there was no work available. */
+    bool run_pending_task();
+
+    /* Wait for the result, executing queued tasks rather than blocking. */
+    template <typename T>
+    T get(std::future<T>& f) {
+        while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!run_pending_task()) {
+                f.wait();
+                break;
+            }
+        }
+        return f.get();
+    }
+};
+
+#endif /* THREAD_POOL_H_ */
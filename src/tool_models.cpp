@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * tool_models.cpp
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#include "tool_models.h"
+#include "geom/primitives.h"
+#include "Tool.h"
+#include "throw_if.h"
+
+namespace po = boost::program_options;
+
+auto tool_models::get(int slot, const machine_config::mill_tool& t, double tolerance) -> const mill& {
+    auto key = std::make_pair(slot, tolerance);
+    auto it = _mill.find(key);
+    if (it != _mill.end())
+        return it->second;
+
+    mill m;
+    m.shank = geom::make_cone( {0, 0, t.length}, {0, 0, t.flute_length}, t.shank_diameter/2, t.shank_diameter/2, cxxcam::facets(t.shank_diameter, tolerance));
+    m.flutes = geom::make_cone( {0, 0, t.flute_length}, {0, 0, 0}, t.diameter/2, t.diameter/2, cxxcam::facets(t.diameter, tolerance));
+    m.is_convex = cxxcam::simulation::make_convex_tool(m.flutes, m.convex);
+    m.mesh = std::make_shared<const mesh::mesh_t>(mesh::to_mesh(m.flutes));
+    return _mill.emplace(key, std::move(m)).first->second;
+}
+
+namespace tool_tolerance {
+
+po::options_description options() {
+    po::options_description options("tool options");
+    options.add_options()
+        ("tolerance", po::value<double>()->default_value(0.02), "Tool model chord height tolerance (mm); coarse for previews, fine for verification")
+    ;
+    return options;
+}
+
+double get(const po::variables_map& vm) {
+    auto tolerance = vm["tolerance"].as<double>();
+    throw_if(tolerance <= 0, "Tolerance must be positive");
+    return tolerance;
+}
+
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026  agent
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * tool_models.h
+ *
+ *  Created on: 2026-10-17
+ *      Author: agent
+ */
+
+#ifndef TOOL_MODELS_H_
+#define TOOL_MODELS_H_
+#include <map>
+#include <utility>
+#include <memory>
+#include <boost/program_options.hpp>
+#include "geom/polyhedron.h"
+#include "base/machine_config.h"
+#include "Simulation.h"
+#include "mesh.h"
+
+/*
+ * Mill tool geometry built from the tool table.
+ * Circles are faceted to a chord height tolerance so the facet count follows
+ * the tool diameter; built models are kept by slot and tolerance so repeated
+ * tool changes do not rebuild them.
+ */
+class tool_models
+{
+public:
+    struct mill {
+        geom::polyhedron_t shank;
+        geom::polyhedron_t flutes;
+        // Flutes as plain data, for use on other threads
+        std::shared_ptr<const mesh::mesh_t> mesh;
+        cxxcam::simulation::convex_tool_t convex;
+        bool is_convex;
+    };
+private:
+    std::map<std::pair<int, double>, mill> _mill;
+public:
+    const mill& get(int slot, const machine_config::mill_tool& tool, double tolerance);
+};
+
+namespace tool_tolerance {
+
+boost::program_options::options_description options();
+
+/* Chord height tolerance (mm) given on the command line. The default of
+ * 0.02 keeps the 32 facets tools had before at 8 mm diameter; smaller tools
+ * get fewer (28 at 6 mm) and larger ones more (36 at 10 mm). */
+double get(const boost::program_options::variables_map& vm);
+
+}
+
+#endif /* TOOL_MODELS_H_ */